@@ -0,0 +1,191 @@
+// Copyright MikeSMediaStudios™ 2023
+
+#include "Environment/BuildingGrid/ChunkCompression.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+void UChunkCompressionUtilities::CompressBlocks(const TArray<int32>& Blocks, TArray<uint8>& OutData)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_STR(TEXT("UChunkCompressionUtilities::CompressBlocks()"))
+
+	TArray<int32> Palette;
+	TMap<int32, uint32> PaletteIndices;
+	TArray<TPair<uint32, uint32>> Runs;
+
+	for (int32 Index = 0; Index < Blocks.Num();)
+	{
+		const int32 Block = Blocks[Index];
+		uint32 RunLength = 1;
+
+		while (Index + static_cast<int32>(RunLength) < Blocks.Num() && Blocks[Index + RunLength] == Block)
+		{
+			RunLength++;
+		}
+
+		const uint32* ExistingIndex = PaletteIndices.Find(Block);
+		const uint32 PaletteIndex = ExistingIndex ? *ExistingIndex : PaletteIndices.Add(Block, Palette.Add(Block));
+
+		Runs.Add(TPair<uint32, uint32>(RunLength, PaletteIndex));
+		Index += RunLength;
+	}
+
+	OutData.Reset();
+	FMemoryWriter Writer(OutData);
+	uint8 Version = sm__FormatVersion;
+	int32 NumBlocks = Blocks.Num();
+	int32 NumRuns = Runs.Num();
+
+	Writer << Version;
+	Writer << NumBlocks;
+	Writer << Palette;
+	Writer << NumRuns;
+
+	for (TPair<uint32, uint32>& Run : Runs)
+	{
+		Writer.SerializeIntPacked(Run.Key);
+		Writer.SerializeIntPacked(Run.Value);
+	}
+}
+
+bool UChunkCompressionUtilities::DecompressBlocks(const TArray<uint8>& Data, TArray<int32>& OutBlocks, const int32 ExpectedNum)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_STR(TEXT("UChunkCompressionUtilities::DecompressBlocks()"))
+
+	FMemoryReader Reader(Data);
+	uint8 Version = 0;
+	int32 NumBlocks = 0;
+	int32 NumPalette = 0;
+	TArray<int32> Palette;
+	int32 NumRuns = 0;
+
+	Reader << Version;
+	Reader << NumBlocks;
+	Reader << NumPalette;
+
+	// Read like Reader << Palette, but a chunk can not hold more distinct blocks than it has blocks, so larger counts are rejected before allocating.
+	if (Reader.IsError() || Version != sm__FormatVersion || NumBlocks != ExpectedNum || NumPalette < 0 || NumPalette > NumBlocks || NumPalette * static_cast<int64>(sizeof(int32)) > Reader.TotalSize() - Reader.Tell())
+		return false;
+
+	Palette.SetNumUninitialized(NumPalette);
+	Reader.Serialize(Palette.GetData(), NumPalette * sizeof(int32));
+	Reader << NumRuns;
+
+	if (Reader.IsError() || NumRuns < 0 || NumRuns > NumBlocks)
+		return false;
+
+	OutBlocks.Reset();
+	OutBlocks.SetNumUninitialized(NumBlocks);
+
+	int32 Written = 0;
+
+	for (int32 Run = 0; Run < NumRuns; Run++)
+	{
+		uint32 RunLength = 0;
+		uint32 PaletteIndex = 0;
+		Reader.SerializeIntPacked(RunLength);
+		Reader.SerializeIntPacked(PaletteIndex);
+
+		if (Reader.IsError() || !Palette.IsValidIndex(PaletteIndex) || RunLength > static_cast<uint32>(NumBlocks - Written))
+			return false;
+
+		const int32 Block = Palette[PaletteIndex];
+
+		for (uint32 Offset = 0; Offset < RunLength; Offset++)
+		{
+			OutBlocks[Written + Offset] = Block;
+		}
+
+		Written += RunLength;
+	}
+
+	return Written == NumBlocks;
+}
+
+void UChunkCompressionUtilities::CompressEditedBlocks(const TArray<TPair<int32, int32>>& EditedBlocks, TArray<uint8>& OutData)
+{
+	OutData.Reset();
+	FMemoryWriter Writer(OutData);
+	uint8 Version = sm__EditedBlocksFormatVersion;
+	int32 NumEdits = EditedBlocks.Num();
+
+	Writer << Version;
+	Writer << NumEdits;
+	__WriteSortedEdits(Writer, EditedBlocks);
+}
+
+bool UChunkCompressionUtilities::DecompressEditedBlocks(const TArray<uint8>& Data, TArray<TPair<int32, int32>>& OutEditedBlocks, const int32 NumBlocks)
+{
+	FMemoryReader Reader(Data);
+	uint8 Version = 0;
+	int32 NumEdits = 0;
+
+	Reader << Version;
+	Reader << NumEdits;
+
+	if (Reader.IsError() || Version != sm__EditedBlocksFormatVersion || NumEdits < 0 || NumEdits > NumBlocks)
+		return false;
+
+	return __ReadSortedEdits(Reader, NumEdits, NumBlocks, OutEditedBlocks);
+}
+
+void UChunkCompressionUtilities::CompressBlockDeltas(const TArray<TPair<int32, int32>>& Deltas, TArray<uint8>& OutData)
+{
+	OutData.Reset();
+	FMemoryWriter Writer(OutData);
+	uint32 NumDeltas = Deltas.Num();
+
+	Writer.SerializeIntPacked(NumDeltas);
+	__WriteSortedEdits(Writer, Deltas);
+}
+
+bool UChunkCompressionUtilities::DecompressBlockDeltas(const TArray<uint8>& Data, TArray<TPair<int32, int32>>& OutDeltas, const int32 NumBlocks)
+{
+	FMemoryReader Reader(Data);
+	uint32 NumDeltas = 0;
+
+	Reader.SerializeIntPacked(NumDeltas);
+
+	if (Reader.IsError() || NumDeltas > static_cast<uint32>(NumBlocks))
+		return false;
+
+	return __ReadSortedEdits(Reader, static_cast<int32>(NumDeltas), NumBlocks, OutDeltas);
+}
+
+void UChunkCompressionUtilities::__WriteSortedEdits(FArchive& Writer, const TArray<TPair<int32, int32>>& Edits)
+{
+	int32 PreviousIndex = 0;
+
+	for (const TPair<int32, int32>& Edit : Edits)
+	{
+		uint32 IndexDelta = Edit.Key - PreviousIndex;
+		uint32 Block = static_cast<uint32>(Edit.Value);
+
+		Writer.SerializeIntPacked(IndexDelta);
+		Writer.SerializeIntPacked(Block);
+		PreviousIndex = Edit.Key;
+	}
+}
+
+bool UChunkCompressionUtilities::__ReadSortedEdits(FArchive& Reader, const int32 NumEdits, const int32 NumBlocks, TArray<TPair<int32, int32>>& OutEdits)
+{
+	OutEdits.Reset(NumEdits);
+
+	int64 Index = 0;
+
+	for (int32 Edit = 0; Edit < NumEdits; Edit++)
+	{
+		uint32 IndexDelta = 0;
+		uint32 Block = 0;
+
+		Reader.SerializeIntPacked(IndexDelta);
+		Reader.SerializeIntPacked(Block);
+		Index += IndexDelta;
+
+		if (Reader.IsError() || Index >= NumBlocks)
+			return false;
+
+		OutEdits.Add(TPair<int32, int32>(static_cast<int32>(Index), static_cast<int32>(Block)));
+	}
+
+	return true;
+}
@@ -0,0 +1,224 @@
+// Copyright MikeSMediaStudios™ 2023
+
+#include "Environment/BuildingGrid/GridEditJournal.h"
+#include "GenericPlatform/GenericPlatformFile.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/Crc.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+namespace
+{
+	// Magic and format version at the start of every segment.
+	constexpr int32 SegmentHeaderSize = sizeof(uint32) * 2;
+
+	// Count and checksum in front of every group.
+	constexpr int32 GroupHeaderSize = sizeof(uint32) * 2;
+	constexpr int32 EntrySize = sizeof(int32) * 6 + sizeof(uint32);
+
+	FArchive& operator<<(FArchive& Archive, FGridEditJournalEntry& Entry)
+	{
+		return Archive << Entry.ChunkPosition << Entry.LocalIndex << Entry.OldBlock << Entry.NewBlock << Entry.Tick;
+	}
+}
+
+FGridEditJournal::FGridEditJournal(const FString& InDirectory)
+	: m__Directory(InDirectory)
+	, m__WritePipe(TEXT("GridEditJournal"))
+{
+}
+
+FGridEditJournal::~FGridEditJournal()
+{
+	// Every queued task holds a reference, so nothing can be in flight anymore at this point.
+}
+
+void FGridEditJournal::ReadAll(const FString& Directory, TArray<FGridEditJournalEntry>& OutEntries, TArray<int32>& OutSegments)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_STR(TEXT("FGridEditJournal::ReadAll()"))
+
+	__FindSegments(Directory, OutSegments);
+
+	for (const int32 Segment : OutSegments)
+	{
+		TArray<uint8> Data;
+
+		if (!FFileHelper::LoadFileToArray(Data, *__GetSegmentFilename(Directory, Segment)))
+			continue;
+
+		uint32 SegmentHeader[2] = { 0, 0 };
+
+		if (Data.Num() >= SegmentHeaderSize)
+			FMemory::Memcpy(SegmentHeader, Data.GetData(), SegmentHeaderSize);
+
+		if (SegmentHeader[0] != sm__Magic || SegmentHeader[1] != sm__FormatVersion)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Skipping journal segment %d in %s, it was written in another format"), Segment, *Directory);
+			continue;
+		}
+
+		int64 Offset = SegmentHeaderSize;
+
+		while (Offset + GroupHeaderSize <= Data.Num())
+		{
+			uint32 Count = 0;
+			uint32 Checksum = 0;
+			FMemory::Memcpy(&Count, Data.GetData() + Offset, sizeof(uint32));
+			FMemory::Memcpy(&Checksum, Data.GetData() + Offset + sizeof(uint32), sizeof(uint32));
+
+			const int64 PayloadSize = static_cast<int64>(Count) * EntrySize;
+			const int64 PayloadOffset = Offset + GroupHeaderSize;
+
+			// Torn write at the end of the segment.
+			if (PayloadOffset + PayloadSize > Data.Num() || FCrc::MemCrc32(Data.GetData() + PayloadOffset, PayloadSize) != Checksum)
+				break;
+
+			const TArray<uint8> Payload(Data.GetData() + PayloadOffset, PayloadSize);
+			FMemoryReader Reader(Payload);
+
+			for (uint32 Entry = 0; Entry < Count; Entry++)
+			{
+				Reader << OutEntries.AddDefaulted_GetRef();
+			}
+
+			Offset = PayloadOffset + PayloadSize;
+		}
+	}
+}
+
+bool FGridEditJournal::Open()
+{
+	TArray<int32> Segments;
+	__FindSegments(m__Directory, Segments);
+
+	m__CurrentSegment = Segments.IsEmpty() ? 0 : Segments.Last() + 1;
+	__OpenSegment(m__CurrentSegment);
+
+	return m__FileHandle.IsValid();
+}
+
+void FGridEditJournal::Append(const FGridEditJournalEntry& Entry)
+{
+	m__Buffer.Add(Entry);
+}
+
+void FGridEditJournal::CommitAsync()
+{
+	if (m__Buffer.IsEmpty())
+		return;
+
+	m__LastWrite = m__WritePipe.Launch(TEXT("FGridEditJournal::CommitAsync"), [This = AsShared(), Entries = MoveTemp(m__Buffer)]()
+		{
+			This->__WriteGroup(Entries);
+		});
+
+	m__Buffer.Reset();
+}
+
+int32 FGridEditJournal::Rotate()
+{
+	CommitAsync();
+
+	const int32 ClosedSegment = m__CurrentSegment++;
+
+	m__LastWrite = m__WritePipe.Launch(TEXT("FGridEditJournal::Rotate"), [This = AsShared(), Segment = m__CurrentSegment]()
+		{
+			This->__OpenSegment(Segment);
+		});
+
+	return ClosedSegment;
+}
+
+void FGridEditJournal::DeleteSegmentsAsync(const int32 LastSegment)
+{
+	// Not tracked in m__LastWrite since this is also called from other threads.
+	m__WritePipe.Launch(TEXT("FGridEditJournal::DeleteSegmentsAsync"), [This = AsShared(), LastSegment]()
+		{
+			TArray<int32> Segments;
+			__FindSegments(This->m__Directory, Segments);
+
+			for (const int32 Segment : Segments)
+			{
+				if (Segment <= LastSegment)
+					IFileManager::Get().Delete(*__GetSegmentFilename(This->m__Directory, Segment));
+			}
+		});
+}
+
+void FGridEditJournal::Flush()
+{
+	CommitAsync();
+
+	if (m__LastWrite.IsValid())
+		m__LastWrite.Wait();
+}
+
+FString FGridEditJournal::__GetSegmentFilename(const FString& Directory, const int32 Segment)
+{
+	return FPaths::Combine(Directory, FString::Printf(TEXT("journal.%06d.log"), Segment));
+}
+
+void FGridEditJournal::__FindSegments(const FString& Directory, TArray<int32>& OutSegments)
+{
+	TArray<FString> Filenames;
+	IFileManager::Get().FindFiles(Filenames, *FPaths::Combine(Directory, TEXT("journal.*.log")), true, false);
+
+	OutSegments.Reset();
+
+	for (const FString& Filename : Filenames)
+	{
+		FString Number;
+
+		if (Filename.Split(TEXT("."), nullptr, &Number) && Number.Split(TEXT("."), &Number, nullptr) && Number.IsNumeric())
+			OutSegments.Add(FCString::Atoi(*Number));
+	}
+
+	OutSegments.Sort();
+}
+
+void FGridEditJournal::__WriteGroup(const TArray<FGridEditJournalEntry>& Entries)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_STR(TEXT("FGridEditJournal::__WriteGroup()"))
+
+	if (!m__FileHandle)
+		return;
+
+	TArray<uint8> Payload;
+	Payload.Reserve(Entries.Num() * EntrySize);
+	FMemoryWriter Writer(Payload);
+
+	for (FGridEditJournalEntry Entry : Entries)
+	{
+		Writer << Entry;
+	}
+
+	const uint32 Header[2] = { static_cast<uint32>(Entries.Num()), FCrc::MemCrc32(Payload.GetData(), Payload.Num()) };
+
+	// One write per group, the checksum catches it if the process dies halfway through.
+	TArray<uint8> Group;
+	Group.Append(reinterpret_cast<const uint8*>(Header), sizeof(Header));
+	Group.Append(Payload);
+
+	if (!m__FileHandle->Write(Group.GetData(), Group.Num()) || !m__FileHandle->Flush(true))
+		UE_LOG(LogTemp, Error, TEXT("Failed to write %d edits to the journal in %s"), Entries.Num(), *m__Directory);
+}
+
+void FGridEditJournal::__OpenSegment(const int32 Segment)
+{
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	PlatformFile.CreateDirectoryTree(*m__Directory);
+
+	m__FileHandle.Reset(PlatformFile.OpenWrite(*__GetSegmentFilename(m__Directory, Segment), true));
+
+	const uint32 SegmentHeader[2] = { sm__Magic, sm__FormatVersion };
+
+	// Segments are always new, the header goes in front of the first group.
+	if (!m__FileHandle || (m__FileHandle->Tell() == 0 && !m__FileHandle->Write(reinterpret_cast<const uint8*>(SegmentHeader), sizeof(SegmentHeader))))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Failed to open journal segment %d in %s"), Segment, *m__Directory);
+		m__FileHandle.Reset();
+	}
+}
@@ -0,0 +1,287 @@
+// Copyright MikeSMediaStudios™ 2023
+
+#include "Environment/BuildingGrid/GridGeneration.h"
+#include "Environment/BuildingGrid/GridUtilities.h"
+#include "Templates/IntegerSequence.h"
+#include "SimplexNoise/Public/SimplexNoiseBPLibrary.h"
+
+namespace
+{
+	// Offsets into the noise field so the biome and ore noise do not correlate with the terrain noise of the same seed.
+	constexpr float BiomeNoiseOffset = 10000.f;
+	constexpr float OreNoiseOffset = 20000.f;
+
+	using FGridGenerationPipelineFunction = void(*)(FGridGenerationContext&);
+
+	template<uint8... StageMasks>
+	FORCEINLINE void ExecutePipelineForMask(FGridGenerationContext& Context, const uint8 StageMask, TIntegerSequence<uint8, StageMasks...>)
+	{
+		static constexpr FGridGenerationPipelineFunction Pipelines[] = { &TGridGenerationPipelineForMask<StageMasks>::Execute... };
+		Pipelines[StageMask & static_cast<uint8>(EGridGenerationStage::GS_All)](Context);
+	}
+}
+
+void UGridGenerationUtilities::GenerateChunk(FGridGenerationContext& Context, const uint8 StageMask)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_STR(TEXT("UGridGenerationUtilities::GenerateChunk()"))
+
+	Context.StoneBlock = UGridUtilities::ConvertUnpackedBlockIDToPacked(Context.Settings.StoneBlock);
+	Context.DirtBlock = UGridUtilities::ConvertUnpackedBlockIDToPacked(Context.Settings.DirtBlock);
+	Context.GrassBlock = UGridUtilities::ConvertUnpackedBlockIDToPacked(Context.Settings.GrassBlock);
+	Context.SandBlock = UGridUtilities::ConvertUnpackedBlockIDToPacked(Context.Settings.SandBlock);
+	Context.OreBlock = UGridUtilities::ConvertUnpackedBlockIDToPacked(Context.Settings.OreBlock);
+	Context.WoodBlock = UGridUtilities::ConvertUnpackedBlockIDToPacked(Context.Settings.WoodBlock);
+	Context.LeavesBlock = UGridUtilities::ConvertUnpackedBlockIDToPacked(Context.Settings.LeavesBlock);
+
+	ExecutePipelineForMask(Context, StageMask, TMakeIntegerSequence<uint8, static_cast<uint8>(EGridGenerationStage::GS_All) + 1>());
+}
+
+void FGridSolidFillStage::Execute(FGridGenerationContext& Context)
+{
+	for (int32& Height : Context.ColumnHeights)
+	{
+		Height = Context.GridHeightInBlocks;
+	}
+
+	for (int32& Block : Context.Blocks)
+	{
+		Block = Context.StoneBlock;
+	}
+}
+
+void FGridHeightmapStage::Execute(FGridGenerationContext& Context)
+{
+	const int32 Width = Context.WidthInBlocks;
+	const FIntVector& Start = Context.StartGridLocation;
+
+	for (int y = 0; y < Width; y++)
+	{
+		for (int x = 0; x < Width; x++)
+		{
+			const float Value = USimplexNoiseBPLibrary::GetSimplexNoise2D_EX(Start.X + x, Start.Y + y, Context.Lucanarity, Context.Persistence, Context.Octaves, Context.Zoom, true);
+			const int Height = (Value * static_cast<float>(Context.Ceiling)) + Context.Floor;
+			Context.ColumnHeights[Context.ColumnIndex(x, y)] = FMath::Clamp(FMath::Max(Height, Context.Floor), 0, Context.GridHeightInBlocks);
+		}
+	}
+
+	for (int z = 0; z < Context.HeightInBlocks; z++)
+	{
+		const int32 GridZ = Start.Z + z;
+
+		for (int y = 0; y < Width; y++)
+		{
+			const int32 RowStart = Context.BlockIndex(0, y, z);
+			const int32 ColumnRowStart = Context.ColumnIndex(0, y);
+
+			for (int x = 0; x < Width; x++)
+			{
+				if (GridZ < Context.ColumnHeights[ColumnRowStart + x])
+					Context.Blocks[RowStart + x] = Context.StoneBlock;
+			}
+		}
+	}
+}
+
+void FGridBiomeStage::Execute(FGridGenerationContext& Context)
+{
+	const int32 Width = Context.WidthInBlocks;
+	const FIntVector& Start = Context.StartGridLocation;
+	const FGridGenerationSettings& Settings = Context.Settings;
+	const float Ceiling = FMath::Max(static_cast<float>(Context.Ceiling), 1.f);
+
+	for (int y = 0; y < Width; y++)
+	{
+		for (int x = 0; x < Width; x++)
+		{
+			const int32 ColumnIndex = Context.ColumnIndex(x, y);
+			const float Elevation = static_cast<float>(Context.ColumnHeights[ColumnIndex] - Context.Floor) / Ceiling;
+
+			if (Elevation > Settings.MountainThreshold)
+			{
+				Context.ColumnBiomes[ColumnIndex] = EGridBiome::GB_Mountains;
+				continue;
+			}
+
+			const float Moisture = USimplexNoiseBPLibrary::GetSimplexNoise2D_EX(Start.X + x + BiomeNoiseOffset, Start.Y + y + BiomeNoiseOffset, Context.Lucanarity, Context.Persistence, 1, Settings.BiomeZoom, true);
+			Context.ColumnBiomes[ColumnIndex] = Moisture < Settings.DesertThreshold ? EGridBiome::GB_Desert : EGridBiome::GB_Plains;
+		}
+	}
+}
+
+void FGridCaveStage::Execute(FGridGenerationContext& Context)
+{
+	const int32 Width = Context.WidthInBlocks;
+	const FIntVector& Start = Context.StartGridLocation;
+	const float Threshold = Context.Settings.CaveThreshold;
+
+	for (int z = 0; z < Context.HeightInBlocks; z++)
+	{
+		for (int y = 0; y < Width; y++)
+		{
+			const int32 RowStart = Context.BlockIndex(0, y, z);
+
+			for (int x = 0; x < Width; x++)
+			{
+				int32& Block = Context.Blocks[RowStart + x];
+
+				// Only solid blocks can be carved, skip the noise sample for everything else.
+				if (!UGridUtilities::IsValidBlock(Block))
+					continue;
+
+				const float Value = USimplexNoiseBPLibrary::GetSimplexNoise3D_EX(Start.X + x, Start.Y + y, Start.Z + z, Context.Lucanarity, Context.Persistence, Context.Octaves, Context.Zoom, true);
+
+				if (Value <= Threshold)
+					Block = 0;
+			}
+		}
+	}
+}
+
+void FGridOreVeinStage::Execute(FGridGenerationContext& Context)
+{
+	const int32 Width = Context.WidthInBlocks;
+	const FIntVector& Start = Context.StartGridLocation;
+	const FGridGenerationSettings& Settings = Context.Settings;
+
+	for (int z = 0; z < Context.HeightInBlocks; z++)
+	{
+		const int32 GridZ = Start.Z + z;
+
+		for (int y = 0; y < Width; y++)
+		{
+			const int32 RowStart = Context.BlockIndex(0, y, z);
+			const int32 ColumnRowStart = Context.ColumnIndex(0, y);
+
+			for (int x = 0; x < Width; x++)
+			{
+				if (GridZ >= Context.ColumnHeights[ColumnRowStart + x] - Settings.OreMinDepth)
+					continue;
+
+				int32& Block = Context.Blocks[RowStart + x];
+
+				if (Block != Context.StoneBlock)
+					continue;
+
+				const float Value = USimplexNoiseBPLibrary::GetSimplexNoise3D_EX(Start.X + x + OreNoiseOffset, Start.Y + y + OreNoiseOffset, GridZ + OreNoiseOffset, Context.Lucanarity, Context.Persistence, 1, Settings.OreZoom, true);
+
+				if (Value > Settings.OreThreshold)
+					Block = Context.OreBlock;
+			}
+		}
+	}
+}
+
+void FGridSurfaceDecorationStage::Execute(FGridGenerationContext& Context)
+{
+	const int32 Width = Context.WidthInBlocks;
+	const FIntVector& Start = Context.StartGridLocation;
+	const int32 EndZ = Start.Z + Context.HeightInBlocks - 1;
+
+	for (int y = 0; y < Width; y++)
+	{
+		for (int x = 0; x < Width; x++)
+		{
+			const int32 ColumnIndex = Context.ColumnIndex(x, y);
+			const int32 TopZ = Context.ColumnHeights[ColumnIndex] - 1;
+			const int32 BottomZ = TopZ - Context.Settings.SurfaceDepth;
+
+			// Surface of this column does not reach into the current chunk.
+			if (TopZ < Start.Z || BottomZ > EndZ)
+				continue;
+
+			int32 TopBlock;
+			int32 SubSurfaceBlock;
+
+			switch (Context.ColumnBiomes[ColumnIndex])
+			{
+			case EGridBiome::GB_Desert:
+				TopBlock = Context.SandBlock;
+				SubSurfaceBlock = Context.SandBlock;
+				break;
+			case EGridBiome::GB_Mountains:
+				continue;
+			case EGridBiome::GB_Plains:
+			default:
+				TopBlock = Context.GrassBlock;
+				SubSurfaceBlock = Context.DirtBlock;
+				break;
+			}
+
+			for (int32 GridZ = FMath::Max(BottomZ, Start.Z); GridZ <= FMath::Min(TopZ, EndZ); GridZ++)
+			{
+				int32& Block = Context.Blocks[Context.BlockIndex(x, y, GridZ - Start.Z)];
+
+				// Leave carved caves and ores alone.
+				if (Block != Context.StoneBlock)
+					continue;
+
+				Block = GridZ == TopZ ? TopBlock : SubSurfaceBlock;
+			}
+		}
+	}
+}
+
+void FGridStructureStage::Execute(FGridGenerationContext& Context)
+{
+	const int32 Width = Context.WidthInBlocks;
+	const FIntVector& Start = Context.StartGridLocation;
+	const FGridGenerationSettings& Settings = Context.Settings;
+	const int32 TreeHeightRange = FMath::Max(Settings.TreeMaxHeight - Settings.TreeMinHeight, 0) + 1;
+
+	for (int y = 0; y < Width; y++)
+	{
+		for (int x = 0; x < Width; x++)
+		{
+			const int32 ColumnIndex = Context.ColumnIndex(x, y);
+			const int32 TopZ = Context.ColumnHeights[ColumnIndex] - 1;
+
+			// The column's surface belongs to another chunk, which will anchor the structure instead.
+			if (TopZ < Start.Z || TopZ >= Start.Z + Context.HeightInBlocks)
+				continue;
+
+			if (Context.ColumnBiomes[ColumnIndex] != EGridBiome::GB_Plains)
+				continue;
+
+			const int32 GroundBlock = Context.Blocks[Context.BlockIndex(x, y, TopZ - Start.Z)];
+			if (!UGridUtilities::IsValidBlock(GroundBlock) || GroundBlock == Context.SandBlock)
+				continue;
+
+			// Deterministic per column so regenerating a chunk always places the same structures.
+			const uint32 Hash = HashCombine(HashCombine(GetTypeHash(Context.Seed), GetTypeHash(Start.X + x)), GetTypeHash(Start.Y + y));
+			const float Roll = static_cast<float>(Hash & 0xffff) / 65535.f;
+
+			if (Roll >= Settings.TreeDensity)
+				continue;
+
+			const int32 TrunkHeight = Settings.TreeMinHeight + static_cast<int32>((Hash >> 16) % TreeHeightRange);
+			__PlaceTree(Context, FIntVector(Start.X + x, Start.Y + y, TopZ), TrunkHeight);
+		}
+	}
+}
+
+void FGridStructureStage::__PlaceTree(FGridGenerationContext& Context, const FIntVector& GroundLocation, const int32 TrunkHeight)
+{
+	const int32 Radius = Context.Settings.TreeCanopyRadius;
+	const int32 RadiusSquared = (Radius * Radius) + 1;
+	const FIntVector CanopyCenter = GroundLocation + FIntVector(0, 0, TrunkHeight);
+
+	// Trunk goes first so the canopy, which only replaces air, cannot cut through it.
+	for (int z = 1; z <= TrunkHeight; z++)
+	{
+		Context.SetBlockOrDefer(GroundLocation + FIntVector(0, 0, z), Context.WoodBlock);
+	}
+
+	for (int dz = -Radius; dz <= Radius; dz++)
+	{
+		for (int dy = -Radius; dy <= Radius; dy++)
+		{
+			for (int dx = -Radius; dx <= Radius; dx++)
+			{
+				if ((dx * dx) + (dy * dy) + (dz * dz) > RadiusSquared)
+					continue;
+
+				Context.SetBlockOrDefer(CanopyCenter + FIntVector(dx, dy, dz), Context.LeavesBlock);
+			}
+		}
+	}
+}
@@ -0,0 +1,132 @@
+// Copyright MikeSMediaStudios™ 2023
+
+#include "Environment/BuildingGrid/GridGenerationCache.h"
+#include "Environment/BuildingGrid/ChunkCompression.h"
+#include "Environment/BuildingGrid/GridUtilities.h"
+#include "HAL/FileManager.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+FGridGenerationCache::FGridGenerationCache(const FString& InParentDirectory, const uint32 InSettingsHash, const int32 InChunkWidthInBlocks, const int32 InChunkHeightInBlocks)
+	: m__ParentDirectory(InParentDirectory)
+	, m__ChunkWidthInBlocks(InChunkWidthInBlocks)
+	, m__ChunkHeightInBlocks(InChunkHeightInBlocks)
+	, m__RegionFiles(FPaths::Combine(InParentDirectory, FString::Printf(TEXT("%08x"), InSettingsHash)), InChunkWidthInBlocks, InChunkHeightInBlocks)
+	, m__WritePipe(TEXT("GridGenerationCache"))
+{
+}
+
+FGridGenerationCache::~FGridGenerationCache()
+{
+	// Every queued task holds a reference, so nothing can be in flight anymore at this point.
+}
+
+bool FGridGenerationCache::ReadChunk(const FIntVector& ChunkPosition, TArray<int32>& OutBlocks, TArray<FGridDeferredWrite>& OutDeferredWrites)
+{
+	FGridRegionFile* RegionFile = m__RegionFiles.GetRegionFile(ChunkPosition);
+	TArray<uint8> Data;
+
+	if (!RegionFile || !RegionFile->ReadChunk(FGridRegionFile::GetLocalIndex(ChunkPosition), Data))
+		return false;
+
+	FMemoryReader Reader(Data);
+	uint8 Version = 0;
+	TArray<uint8> CompressedBlocks;
+	int32 NumWrites = 0;
+
+	Reader << Version;
+
+	if (Reader.IsError() || Version != sm__FormatVersion)
+		return false;
+
+	Reader << CompressedBlocks;
+	Reader << NumWrites;
+
+	if (Reader.IsError() || NumWrites < 0 || !UChunkCompressionUtilities::DecompressBlocks(CompressedBlocks, OutBlocks, UGridUtilities::GetArrayDesiredSize(m__ChunkWidthInBlocks, m__ChunkHeightInBlocks)))
+		return false;
+
+	OutDeferredWrites.Reset(NumWrites);
+
+	for (int32 Write = 0; Write < NumWrites; Write++)
+	{
+		FGridDeferredWrite& DeferredWrite = OutDeferredWrites.AddDefaulted_GetRef();
+		uint8 bOnlyReplaceAir = 0;
+
+		Reader << DeferredWrite.GridLocation;
+		Reader << DeferredWrite.Block;
+		Reader << bOnlyReplaceAir;
+		DeferredWrite.bOnlyReplaceAir = bOnlyReplaceAir != 0;
+	}
+
+	return !Reader.IsError();
+}
+
+void FGridGenerationCache::WriteChunk(const FIntVector& ChunkPosition, const TArray<int32>& Blocks, const TArray<FGridDeferredWrite>& DeferredWrites)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_STR(TEXT("FGridGenerationCache::WriteChunk()"))
+
+	FGridRegionFile* RegionFile = m__RegionFiles.GetRegionFile(ChunkPosition);
+
+	if (!RegionFile)
+		return;
+
+	TArray<uint8> CompressedBlocks;
+	UChunkCompressionUtilities::CompressBlocks(Blocks, CompressedBlocks);
+
+	TArray<uint8> Data;
+	FMemoryWriter Writer(Data);
+	uint8 Version = sm__FormatVersion;
+	int32 NumWrites = DeferredWrites.Num();
+
+	Writer << Version;
+	Writer << CompressedBlocks;
+	Writer << NumWrites;
+
+	for (FGridDeferredWrite DeferredWrite : DeferredWrites)
+	{
+		uint8 bOnlyReplaceAir = DeferredWrite.bOnlyReplaceAir ? 1 : 0;
+
+		Writer << DeferredWrite.GridLocation;
+		Writer << DeferredWrite.Block;
+		Writer << bOnlyReplaceAir;
+	}
+
+	if (RegionFile->WriteChunk(FGridRegionFile::GetLocalIndex(ChunkPosition), MoveTemp(Data)))
+		m__bHasStagedChunks = true;
+}
+
+void FGridGenerationCache::CommitAsync()
+{
+	if (!m__bHasStagedChunks.exchange(false))
+		return;
+
+	m__LastWrite = m__WritePipe.Launch(TEXT("FGridGenerationCache::CommitAsync"), [This = AsShared()]()
+		{
+			// A failed region only costs generating its chunks again on the next start.
+			This->m__RegionFiles.CommitAll();
+		});
+}
+
+void FGridGenerationCache::DeleteStaleCachesAsync()
+{
+	m__LastWrite = m__WritePipe.Launch(TEXT("FGridGenerationCache::DeleteStaleCachesAsync"), [This = AsShared()]()
+		{
+			TArray<FString> Directories;
+			IFileManager::Get().FindFiles(Directories, *FPaths::Combine(This->m__ParentDirectory, TEXT("*")), false, true);
+
+			const FString CurrentName = FPaths::GetCleanFilename(This->GetDirectory());
+
+			for (const FString& Directory : Directories)
+			{
+				if (Directory != CurrentName)
+					IFileManager::Get().DeleteDirectory(*FPaths::Combine(This->m__ParentDirectory, Directory), false, true);
+			}
+		});
+}
+
+void FGridGenerationCache::Flush()
+{
+	if (m__LastWrite.IsValid())
+		m__LastWrite.Wait();
+}
@@ -0,0 +1,152 @@
+// Copyright MikeSMediaStudios™ 2023
+
+#include "Environment/BuildingGrid/GridMeshCache.h"
+#include "Environment/BuildingGrid/GridMeshUtilities.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+namespace
+{
+	template<typename ToType, typename FromType>
+	TArray<ToType> ConvertArray(const TArray<FromType>& From)
+	{
+		TArray<ToType> To;
+		To.Reserve(From.Num());
+
+		for (const FromType& Value : From)
+		{
+			To.Emplace(Value);
+		}
+
+		return To;
+	}
+
+	// Stored in single precision, meshes are local to their chunk so nothing is lost.
+	void WritePackedMesh(FArchive& Archive, const FVoxelMeshSectionData& MeshData)
+	{
+		TArray<FVector3f> Positions = ConvertArray<FVector3f>(MeshData.Positions);
+		TArray<FVector3f> Normals = ConvertArray<FVector3f>(MeshData.Normals);
+		TArray<FVector2f> UVs = ConvertArray<FVector2f>(MeshData.UVs);
+		TArray<int32> Triangles = MeshData.Triangles;
+		TArray<FVector3f> Tangents;
+		TArray<uint8> FlipTangentsY;
+
+		for (const FProcMeshTangent& Tangent : MeshData.Tangents)
+		{
+			Tangents.Emplace(Tangent.TangentX);
+			FlipTangentsY.Add(Tangent.bFlipTangentY ? 1 : 0);
+		}
+
+		Archive << Positions << Normals << UVs << Tangents << FlipTangentsY << Triangles;
+	}
+
+	bool ReadPackedMesh(FArchive& Archive, FVoxelMeshSectionData& OutMeshData)
+	{
+		TArray<FVector3f> Positions;
+		TArray<FVector3f> Normals;
+		TArray<FVector2f> UVs;
+		TArray<FVector3f> Tangents;
+		TArray<uint8> FlipTangentsY;
+
+		Archive << Positions << Normals << UVs << Tangents << FlipTangentsY << OutMeshData.Triangles;
+
+		if (Archive.IsError() || Tangents.Num() != FlipTangentsY.Num())
+			return false;
+
+		OutMeshData.Positions = ConvertArray<FVector>(Positions);
+		OutMeshData.Normals = ConvertArray<FVector>(Normals);
+		OutMeshData.UVs = ConvertArray<FVector2D>(UVs);
+		OutMeshData.Tangents.Reset(Tangents.Num());
+
+		for (int32 Index = 0; Index < Tangents.Num(); Index++)
+		{
+			OutMeshData.Tangents.Emplace(FVector(Tangents[Index]), FlipTangentsY[Index] != 0);
+		}
+
+		return true;
+	}
+}
+
+FGridMeshCache::FGridMeshCache(const FString& InDirectory, const int32 InChunkWidthInBlocks, const int32 InChunkHeightInBlocks)
+	: m__RegionFiles(InDirectory, InChunkWidthInBlocks, InChunkHeightInBlocks)
+	, m__WritePipe(TEXT("GridMeshCache"))
+{
+}
+
+FGridMeshCache::~FGridMeshCache()
+{
+	// Every queued task holds a reference, so nothing can be in flight anymore at this point.
+}
+
+bool FGridMeshCache::ReadMesh(const FIntVector& ChunkPosition, const uint64 ContentHash, const uint8 Algorithm, const int32 BlockSize, FVoxelMeshSectionData& OutMeshData)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_STR(TEXT("FGridMeshCache::ReadMesh()"))
+
+	FGridRegionFile* RegionFile = m__RegionFiles.GetRegionFile(ChunkPosition);
+	TArray<uint8> Data;
+
+	if (!RegionFile || !RegionFile->ReadChunk(FGridRegionFile::GetLocalIndex(ChunkPosition), Data))
+		return false;
+
+	FMemoryReader Reader(Data);
+	uint8 Version = 0;
+	uint32 CachedMesherVersion = 0;
+	uint64 CachedContentHash = 0;
+	uint8 CachedAlgorithm = 0;
+	int32 CachedBlockSize = 0;
+
+	Reader << Version;
+
+	if (Reader.IsError() || Version != sm__FormatVersion)
+		return false;
+
+	Reader << CachedMesherVersion << CachedContentHash << CachedAlgorithm << CachedBlockSize;
+
+	// Anything that changes the mesh but not the blocks has to be checked here.
+	if (Reader.IsError() || CachedMesherVersion != UGridMeshUtilities::MesherVersion || CachedContentHash != ContentHash || CachedAlgorithm != Algorithm || CachedBlockSize != BlockSize)
+		return false;
+
+	return ReadPackedMesh(Reader, OutMeshData);
+}
+
+void FGridMeshCache::WriteMesh(const FIntVector& ChunkPosition, const uint64 ContentHash, const uint8 Algorithm, const int32 BlockSize, const FVoxelMeshSectionData& MeshData)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_STR(TEXT("FGridMeshCache::WriteMesh()"))
+
+	FGridRegionFile* RegionFile = m__RegionFiles.GetRegionFile(ChunkPosition);
+
+	if (!RegionFile)
+		return;
+
+	TArray<uint8> Data;
+	FMemoryWriter Writer(Data);
+	uint8 Version = sm__FormatVersion;
+	uint32 CachedMesherVersion = UGridMeshUtilities::MesherVersion;
+	uint64 CachedContentHash = ContentHash;
+	uint8 CachedAlgorithm = Algorithm;
+	int32 CachedBlockSize = BlockSize;
+
+	Writer << Version << CachedMesherVersion << CachedContentHash << CachedAlgorithm << CachedBlockSize;
+	WritePackedMesh(Writer, MeshData);
+
+	if (RegionFile->WriteChunk(FGridRegionFile::GetLocalIndex(ChunkPosition), MoveTemp(Data)))
+		m__bHasStagedMeshes = true;
+}
+
+void FGridMeshCache::CommitAsync()
+{
+	if (!m__bHasStagedMeshes.exchange(false))
+		return;
+
+	m__LastWrite = m__WritePipe.Launch(TEXT("FGridMeshCache::CommitAsync"), [This = AsShared()]()
+		{
+			// A failed region only costs meshing its chunks again.
+			This->m__RegionFiles.CommitAll();
+		});
+}
+
+void FGridMeshCache::Flush()
+{
+	if (m__LastWrite.IsValid())
+		m__LastWrite.Wait();
+}
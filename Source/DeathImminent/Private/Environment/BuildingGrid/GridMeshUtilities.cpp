@@ -1,8 +1,10 @@
-// Copyright MikeSMediaStudios 2023
+// Copyright MikeSMediaStudios™ 2023
 
 #include "Environment/BuildingGrid/GridMeshUtilities.h"
 #include "KismetProceduralMeshLibrary.h"
 #include "Environment/BuildingGrid/Chunk.h"
+#include "Environment/BuildingGrid/BuildingGrid.h"
+#include "Hash/CityHash.h"
 #include "Environment/Blocks/BlockStructs.h"
 
 void UGridMeshUtilities::SetDataForMeshingAlgorithms(AChunk* Chunk)
@@ -17,7 +19,44 @@ void UGridMeshUtilities::SetDataForMeshingAlgorithms(AChunk* Chunk)
 	sm_OwnerTransform = Chunk->GetActorTransform();
 	sm_OwnerLocation = sm_OwnerTransform.GetLocation();
 	sm_OwnerExtent = Chunk->m__OverlapCollision->GetUnscaledBoxExtent();
-	sm_BlocksArray = Chunk->m__Blocks;
+	sm_BlocksArray = Chunk->__GetBlocks();
+}
+
+uint64 UGridMeshUtilities::GetMeshInputHash(const AChunk* Chunk, const bool IncludeNeighbours)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_STR(TEXT("UGridMeshUtilities::GetMeshInputHash()"))
+
+	if (!Chunk)
+		return 0;
+
+	const TArray<int32>& Blocks = Chunk->__GetBlocks();
+	const uint64 BlocksHash = CityHash64(reinterpret_cast<const char*>(Blocks.GetData()), Blocks.Num() * sizeof(int32));
+
+	if (!IncludeNeighbours || !Chunk->m__ContainingGrid)
+		return BlocksHash;
+
+	const int32 Width = Chunk->m__WidthInBlocks;
+	const int32 Height = Chunk->m__HeightInBlocks;
+	const FIntVector& Start = Chunk->m__StartGridLocation;
+
+	TArray<int32> Border;
+	Border.Reserve(((Width + 2) * (Width + 2) * (Height + 2)) - (Width * Width * Height));
+
+	for (int z = -1; z <= Height; z++)
+	{
+		for (int y = -1; y <= Width; y++)
+		{
+			for (int x = -1; x <= Width; x++)
+			{
+				if (x >= 0 && x < Width && y >= 0 && y < Width && z >= 0 && z < Height)
+					continue;
+
+				Border.Add(UGridUtilities::ConvertUnpackedBlockIDToPacked(Chunk->m__ContainingGrid->GetBlockAtGridLocation(Start.X + x, Start.Y + y, Start.Z + z)));
+			}
+		}
+	}
+
+	return CityHash64WithSeed(reinterpret_cast<const char*>(Border.GetData()), Border.Num() * sizeof(int32), BlocksHash);
 }
 
 void UGridMeshUtilities::GreedyMeshing(FVoxelMeshSectionData& MeshData)
@@ -0,0 +1,470 @@
+// Copyright MikeSMediaStudios™ 2023
+
+#include "Environment/BuildingGrid/GridRegionFile.h"
+#include "Environment/BuildingGrid/ChunkCompression.h"
+#include "Environment/BuildingGrid/GridUtilities.h"
+#include "GenericPlatform/GenericPlatformFile.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/Paths.h"
+
+FGridRegionFile::FGridRegionFile(const FString& InFilename, const int32 InChunkWidthInBlocks, const int32 InChunkHeightInBlocks)
+	: m__Filename(InFilename)
+	, m__ChunkWidthInBlocks(InChunkWidthInBlocks)
+	, m__ChunkHeightInBlocks(InChunkHeightInBlocks)
+{
+}
+
+FGridRegionFile::~FGridRegionFile()
+{
+	// Defined here so TUniquePtr sees the complete IFileHandle.
+}
+
+bool FGridRegionFile::Open()
+{
+	FScopeLock Lock(&m__Lock);
+
+	if (m__FileHandle)
+		return true;
+
+	FMemory::Memzero(m__Table);
+
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	const FString TemporaryFilename = __GetTemporaryFilename();
+
+	// The commit got interrupted after removing the old region but before moving the new one in place.
+	// Without a region file the temporary one may also be the first commit that never finished writing, that one is dropped below.
+	if (!PlatformFile.FileExists(*m__Filename) && PlatformFile.FileExists(*TemporaryFilename) && __IsCompleteRegionFile(TemporaryFilename))
+		IFileManager::Get().Move(*m__Filename, *TemporaryFilename);
+
+	// Leftover from a commit that never finished writing, the region file itself is still intact or was never committed.
+	if (PlatformFile.FileExists(*TemporaryFilename))
+		PlatformFile.DeleteFile(*TemporaryFilename);
+
+	// Nothing committed yet, the file is created on the first commit.
+	if (!PlatformFile.FileExists(*m__Filename))
+		return true;
+
+	m__FileHandle.Reset(PlatformFile.OpenRead(*m__Filename));
+
+	if (!m__FileHandle)
+		return false;
+
+	if (!__ReadHeader(*m__FileHandle, m__Table, m__FileVersion))
+	{
+		m__FileHandle.Reset();
+		FMemory::Memzero(m__Table);
+		return false;
+	}
+
+	return true;
+}
+
+bool FGridRegionFile::ReadChunk(const int32 LocalIndex, TArray<uint8>& OutData, uint32* OutVersion)
+{
+	FScopeLock Lock(&m__Lock);
+
+	if (LocalIndex < 0 || LocalIndex >= ChunksPerRegion)
+		return false;
+
+	if (const TArray<uint8>* StagedChunk = m__StagedChunks.Find(LocalIndex))
+	{
+		OutData = *StagedChunk;
+
+		if (OutVersion)
+			*OutVersion = sm__Version;
+
+		return true;
+	}
+
+	if (OutVersion)
+		*OutVersion = m__FileVersion;
+
+	return __ReadCommittedChunk(LocalIndex, OutData);
+}
+
+bool FGridRegionFile::WriteChunk(const int32 LocalIndex, TArray<uint8>&& Data)
+{
+	FScopeLock Lock(&m__Lock);
+
+	if (LocalIndex < 0 || LocalIndex >= ChunksPerRegion || Data.IsEmpty())
+		return false;
+
+	m__StagedChunks.Add(LocalIndex, MoveTemp(Data));
+	return true;
+}
+
+bool FGridRegionFile::HasChunk(const int32 LocalIndex)
+{
+	FScopeLock Lock(&m__Lock);
+	return LocalIndex >= 0 && LocalIndex < ChunksPerRegion && (m__StagedChunks.Contains(LocalIndex) || m__Table[LocalIndex].SectorOffset != 0);
+}
+
+bool FGridRegionFile::Commit()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_STR(TEXT("FGridRegionFile::Commit()"))
+
+	FScopeLock CommitLock(&m__CommitLock);
+
+	// Only the snapshot is taken under the lock, the file is written without it so chunk generation reading this region is not held up.
+	TMap<int32, TArray<uint8>> StagedChunks;
+	FTableEntry Table[ChunksPerRegion];
+
+	{
+		FScopeLock Lock(&m__Lock);
+
+		if (m__StagedChunks.IsEmpty())
+			return true;
+
+		StagedChunks = m__StagedChunks;
+		FMemory::Memcpy(Table, m__Table, sizeof(Table));
+	}
+
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	PlatformFile.CreateDirectoryTree(*FPaths::GetPath(m__Filename));
+
+	const FString TemporaryFilename = __GetTemporaryFilename();
+	TUniquePtr<IFileHandle> TemporaryFile(PlatformFile.OpenWrite(*TemporaryFilename));
+
+	// A handle of its own, the shared one is only used under the lock. Only commits change the file and they are serialized.
+	TUniquePtr<IFileHandle> CommittedFile(PlatformFile.FileExists(*m__Filename) ? PlatformFile.OpenRead(*m__Filename) : nullptr);
+
+	if (!TemporaryFile)
+		return false;
+
+	// Chunks are packed one after another in index order, which also compacts away the space of chunks that shrank.
+	FTableEntry NewTable[ChunksPerRegion];
+	uint32 NextSector = sm__HeaderSectors;
+	TArray<uint8> Data;
+	TArray<uint8> Padding;
+
+	for (int32 LocalIndex = 0; LocalIndex < ChunksPerRegion; LocalIndex++)
+	{
+		const TArray<uint8>* StagedChunk = StagedChunks.Find(LocalIndex);
+
+		if (!StagedChunk && !__ReadCommittedChunk(CommittedFile.Get(), Table[LocalIndex], Data))
+			continue;
+
+		const TArray<uint8>& ChunkData = StagedChunk ? *StagedChunk : Data;
+		const uint32 SectorCount = __GetSectorCount(ChunkData.Num());
+
+		NewTable[LocalIndex].SectorOffset = NextSector;
+		NewTable[LocalIndex].ByteLength = ChunkData.Num();
+
+		Padding.SetNumZeroed((SectorCount * SectorSize) - ChunkData.Num());
+
+		if (!TemporaryFile->Seek(NextSector * SectorSize) || !TemporaryFile->Write(ChunkData.GetData(), ChunkData.Num()) || !TemporaryFile->Write(Padding.GetData(), Padding.Num()))
+			return false;
+
+		NextSector += SectorCount;
+	}
+
+	const uint32 Header[4] = { sm__Magic, sm__Version, static_cast<uint32>(m__ChunkWidthInBlocks), static_cast<uint32>(m__ChunkHeightInBlocks) };
+
+	if (!TemporaryFile->Seek(0) || !TemporaryFile->Write(reinterpret_cast<const uint8*>(Header), sizeof(Header)) || !TemporaryFile->Write(reinterpret_cast<const uint8*>(NewTable), sizeof(NewTable)) || !TemporaryFile->Flush(true))
+		return false;
+
+	TemporaryFile.Reset();
+	CommittedFile.Reset();
+
+	FScopeLock Lock(&m__Lock);
+	m__FileHandle.Reset();
+
+	if (!IFileManager::Get().Move(*m__Filename, *TemporaryFilename, true))
+	{
+		// The old region is still in place, keep serving it and retry on the next commit.
+		m__FileHandle.Reset(PlatformFile.OpenRead(*m__Filename));
+		return false;
+	}
+
+	FMemory::Memcpy(m__Table, NewTable, sizeof(NewTable));
+	m__FileVersion = sm__Version;
+	m__FileHandle.Reset(PlatformFile.OpenRead(*m__Filename));
+
+	// Chunks staged again while the file was written stay staged for the next commit.
+	for (const TPair<int32, TArray<uint8>>& StagedChunk : StagedChunks)
+	{
+		const TArray<uint8>* CurrentChunk = m__StagedChunks.Find(StagedChunk.Key);
+
+		if (CurrentChunk && *CurrentChunk == StagedChunk.Value)
+			m__StagedChunks.Remove(StagedChunk.Key);
+	}
+
+	return m__FileHandle.IsValid();
+}
+
+bool FGridRegionFile::__ReadHeader(IFileHandle& FileHandle, FTableEntry* OutTable, uint32& OutVersion) const
+{
+	uint32 Header[4];
+	const bool bRead = FileHandle.Seek(0) && FileHandle.Read(reinterpret_cast<uint8*>(Header), sizeof(Header)) && FileHandle.Read(reinterpret_cast<uint8*>(OutTable), sizeof(FTableEntry) * ChunksPerRegion);
+
+	if (!bRead || Header[0] != sm__Magic || (Header[1] != sm__Version && Header[1] != FirstVersion) || Header[2] != static_cast<uint32>(m__ChunkWidthInBlocks) || Header[3] != static_cast<uint32>(m__ChunkHeightInBlocks))
+		return false;
+
+	// Reads allocate ByteLength up front, so every entry has to lie within the sectors the file actually has.
+	const int64 FileSize = FileHandle.Size();
+
+	for (int32 LocalIndex = 0; LocalIndex < ChunksPerRegion; LocalIndex++)
+	{
+		const FTableEntry& Entry = OutTable[LocalIndex];
+
+		if (Entry.SectorOffset != 0 && (Entry.SectorOffset < sm__HeaderSectors || (static_cast<int64>(Entry.SectorOffset) * SectorSize) + Entry.ByteLength > FileSize))
+			return false;
+	}
+
+	OutVersion = Header[1];
+	return true;
+}
+
+bool FGridRegionFile::__IsCompleteRegionFile(const FString& Filename) const
+{
+	TUniquePtr<IFileHandle> FileHandle(FPlatformFileManager::Get().GetPlatformFile().OpenRead(*Filename));
+	FTableEntry Table[ChunksPerRegion];
+	uint32 Version;
+
+	return FileHandle && __ReadHeader(*FileHandle, Table, Version);
+}
+
+bool FGridRegionFile::__ReadCommittedChunk(const int32 LocalIndex, TArray<uint8>& OutData)
+{
+	return __ReadCommittedChunk(m__FileHandle.Get(), m__Table[LocalIndex], OutData);
+}
+
+bool FGridRegionFile::__ReadCommittedChunk(IFileHandle* FileHandle, const FTableEntry& Entry, TArray<uint8>& OutData)
+{
+	if (!FileHandle || Entry.SectorOffset == 0)
+		return false;
+
+	// Entries were checked against the file size by __ReadHeader, or were written by Commit itself.
+	OutData.SetNumUninitialized(Entry.ByteLength);
+
+	return FileHandle->Seek(static_cast<int64>(Entry.SectorOffset) * SectorSize) && FileHandle->Read(OutData.GetData(), Entry.ByteLength);
+}
+
+FGridRegionFileSet::FGridRegionFileSet(const FString& InDirectory, const int32 InChunkWidthInBlocks, const int32 InChunkHeightInBlocks)
+	: m__Directory(InDirectory)
+	, m__ChunkWidthInBlocks(InChunkWidthInBlocks)
+	, m__ChunkHeightInBlocks(InChunkHeightInBlocks)
+{
+}
+
+FGridRegionFile* FGridRegionFileSet::GetRegionFile(const FIntVector& ChunkPosition)
+{
+	const FIntVector RegionPosition = FGridRegionFile::GetRegionPosition(ChunkPosition);
+
+	FScopeLock Lock(&m__Lock);
+
+	if (const TUniquePtr<FGridRegionFile>* RegionFile = m__RegionFiles.Find(RegionPosition))
+		return RegionFile->Get();
+
+	const FString Filename = FPaths::Combine(m__Directory, FString::Printf(TEXT("r.%d.%d.%d.region"), RegionPosition.X, RegionPosition.Y, RegionPosition.Z));
+	TUniquePtr<FGridRegionFile> RegionFile = MakeUnique<FGridRegionFile>(Filename, m__ChunkWidthInBlocks, m__ChunkHeightInBlocks);
+
+	if (!RegionFile->Open())
+	{
+		UE_LOG(LogTemp, Error, TEXT("Failed to open region file %s"), *Filename);
+		return nullptr;
+	}
+
+	return m__RegionFiles.Add(RegionPosition, MoveTemp(RegionFile)).Get();
+}
+
+bool FGridRegionFileSet::CommitAll()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_STR(TEXT("FGridRegionFileSet::CommitAll()"))
+
+	TArray<FGridRegionFile*> RegionFiles;
+
+	{
+		FScopeLock Lock(&m__Lock);
+
+		for (const TPair<FIntVector, TUniquePtr<FGridRegionFile>>& RegionFile : m__RegionFiles)
+		{
+			RegionFiles.Add(RegionFile.Value.Get());
+		}
+	}
+
+	bool bCommitted = true;
+
+	for (FGridRegionFile* RegionFile : RegionFiles)
+	{
+		if (RegionFile->Commit())
+			continue;
+
+		UE_LOG(LogTemp, Error, TEXT("Failed to commit a region in %s, its chunks stay staged until the next commit"), *m__Directory);
+		bCommitted = false;
+	}
+
+	return bCommitted;
+}
+
+FGridRegionStorage::FGridRegionStorage(const FString& InDirectory, const int32 InChunkWidthInBlocks, const int32 InChunkHeightInBlocks)
+	: m__Directory(InDirectory)
+	, m__ChunkWidthInBlocks(InChunkWidthInBlocks)
+	, m__ChunkHeightInBlocks(InChunkHeightInBlocks)
+	, m__RegionFiles(InDirectory, InChunkWidthInBlocks, InChunkHeightInBlocks)
+	, m__WritePipe(TEXT("GridRegionStorage"))
+{
+}
+
+FGridRegionStorage::~FGridRegionStorage()
+{
+	// Every queued task holds a reference, so nothing can be in flight anymore at this point.
+}
+
+bool FGridRegionStorage::ReadChunk(const FIntVector& ChunkPosition, FGridChunkSaveData& OutData)
+{
+	{
+		FScopeLock Lock(&m__PendingWritesLock);
+
+		if (const FPendingWrite* PendingWrite = m__PendingWrites.Find(ChunkPosition))
+		{
+			OutData = PendingWrite->Data;
+			return true;
+		}
+	}
+
+	FGridRegionFile* RegionFile = m__RegionFiles.GetRegionFile(ChunkPosition);
+
+	if (!RegionFile)
+		return false;
+
+	TArray<uint8> Data;
+	uint32 FileVersion = 0;
+
+	if (!RegionFile->ReadChunk(FGridRegionFile::GetLocalIndex(ChunkPosition), Data, &FileVersion) || Data.IsEmpty())
+		return false;
+
+	const int32 NumBlocks = UGridUtilities::GetArrayDesiredSize(m__ChunkWidthInBlocks, m__ChunkHeightInBlocks);
+
+	// Before chunks started with their kind they were the compressed blocks alone, the first version holds chunks of both layouts.
+	if (FileVersion == FGridRegionFile::FirstVersion && UChunkCompressionUtilities::DecompressBlocks(Data, OutData.Blocks, NumBlocks))
+	{
+		OutData.Kind = EGridChunkSaveKind::SK_AllBlocks;
+		return true;
+	}
+
+	// The first byte says what kind of save follows.
+	const TArray<uint8> Payload(Data.GetData() + 1, Data.Num() - 1);
+	bool bDecompressed = false;
+
+	switch (static_cast<EGridChunkSaveKind>(Data[0]))
+	{
+	case EGridChunkSaveKind::SK_AllBlocks:
+		OutData.Kind = EGridChunkSaveKind::SK_AllBlocks;
+		bDecompressed = UChunkCompressionUtilities::DecompressBlocks(Payload, OutData.Blocks, NumBlocks);
+		break;
+	case EGridChunkSaveKind::SK_EditedBlocks:
+		OutData.Kind = EGridChunkSaveKind::SK_EditedBlocks;
+		bDecompressed = UChunkCompressionUtilities::DecompressEditedBlocks(Payload, OutData.EditedBlocks, NumBlocks);
+		break;
+	default:
+		break;
+	}
+
+	// The chunk is regenerated instead, which loses its edits, so this should not go unnoticed.
+	if (!bDecompressed)
+		UE_LOG(LogTemp, Warning, TEXT("Failed to decode saved chunk %s in %s, it is corrupted or was saved in a format that is no longer supported"), *ChunkPosition.ToString(), *m__Directory);
+
+	return bDecompressed;
+}
+
+void FGridRegionStorage::WriteChunkAsync(const FIntVector& ChunkPosition, FGridChunkSaveData Data)
+{
+	uint64 Serial;
+
+	{
+		FScopeLock Lock(&m__PendingWritesLock);
+		Serial = m__NextSerial++;
+
+		FPendingWrite& PendingWrite = m__PendingWrites.FindOrAdd(ChunkPosition);
+		PendingWrite.Data = MoveTemp(Data);
+		PendingWrite.Serial = Serial;
+	}
+
+	m__LastWrite = m__WritePipe.Launch(TEXT("FGridRegionStorage::WriteChunkAsync"), [This = AsShared(), ChunkPosition, Serial]()
+		{
+			This->__WritePending(ChunkPosition, Serial);
+		});
+}
+
+void FGridRegionStorage::CommitAsync(TFunction<void(bool bCommitted)>&& OnCommitted)
+{
+	m__LastWrite = m__WritePipe.Launch(TEXT("FGridRegionStorage::CommitAsync"), [This = AsShared(), OnCommitted = MoveTemp(OnCommitted)]()
+		{
+			const bool bCommitted = This->m__RegionFiles.CommitAll();
+
+			if (OnCommitted)
+				OnCommitted(bCommitted);
+		});
+}
+
+bool FGridRegionStorage::HasChunk(const FIntVector& ChunkPosition)
+{
+	{
+		FScopeLock Lock(&m__PendingWritesLock);
+
+		if (m__PendingWrites.Contains(ChunkPosition))
+			return true;
+	}
+
+	FGridRegionFile* RegionFile = m__RegionFiles.GetRegionFile(ChunkPosition);
+	return RegionFile && RegionFile->HasChunk(FGridRegionFile::GetLocalIndex(ChunkPosition));
+}
+
+void FGridRegionStorage::Flush()
+{
+	if (m__LastWrite.IsValid())
+		m__LastWrite.Wait();
+}
+
+int32 FGridRegionStorage::GetNumPendingWrites() const
+{
+	FScopeLock Lock(&m__PendingWritesLock);
+	return m__PendingWrites.Num();
+}
+
+void FGridRegionStorage::__WritePending(const FIntVector& ChunkPosition, const uint64 Serial)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_STR(TEXT("FGridRegionStorage::__WritePending()"))
+
+	FGridChunkSaveData SaveData;
+
+	{
+		FScopeLock Lock(&m__PendingWritesLock);
+		const FPendingWrite* PendingWrite = m__PendingWrites.Find(ChunkPosition);
+
+		// A newer write for the same chunk was queued after this one and will write its data instead.
+		if (!PendingWrite || PendingWrite->Serial != Serial)
+			return;
+
+		SaveData = PendingWrite->Data;
+	}
+
+	TArray<uint8> Payload;
+
+	if (SaveData.Kind == EGridChunkSaveKind::SK_AllBlocks)
+		UChunkCompressionUtilities::CompressBlocks(SaveData.Blocks, Payload);
+	else
+		UChunkCompressionUtilities::CompressEditedBlocks(SaveData.EditedBlocks, Payload);
+
+	TArray<uint8> Data;
+	Data.Reserve(Payload.Num() + 1);
+	Data.Add(static_cast<uint8>(SaveData.Kind));
+	Data.Append(Payload);
+
+	FGridRegionFile* RegionFile = m__RegionFiles.GetRegionFile(ChunkPosition);
+
+	// Kept pending on failure so the data is at least served from memory until the next write of that chunk.
+	if (!RegionFile || !RegionFile->WriteChunk(FGridRegionFile::GetLocalIndex(ChunkPosition), MoveTemp(Data)))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Failed to write chunk %s to %s"), *ChunkPosition.ToString(), *m__Directory);
+		return;
+	}
+
+	FScopeLock Lock(&m__PendingWritesLock);
+	const FPendingWrite* PendingWrite = m__PendingWrites.Find(ChunkPosition);
+
+	if (PendingWrite && PendingWrite->Serial == Serial)
+		m__PendingWrites.Remove(ChunkPosition);
+}
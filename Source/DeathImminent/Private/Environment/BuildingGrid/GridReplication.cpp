@@ -0,0 +1,600 @@
+// Copyright MikeSMediaStudios™ 2023
+
+#include "Environment/BuildingGrid/GridReplication.h"
+#include "Environment/BuildingGrid/BuildingGrid.h"
+#include "Environment/BuildingGrid/ChunkCompression.h"
+#include "GameFramework/PlayerController.h"
+#include "Net/UnrealNetwork.h"
+
+UGridReplicationComponent::UGridReplicationComponent()
+{
+	PrimaryComponentTick.bCanEverTick = true;
+	m__Grid = nullptr;
+}
+
+void UGridReplicationComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	if (!m__Grid)
+		return;
+
+	if (GetOwner()->HasAuthority())
+	{
+		__TickServer(DeltaTime);
+		return;
+	}
+
+	if (m__PendingAcks.IsEmpty())
+		return;
+
+	__ServerAcknowledgeFragments(m__PendingAcks);
+	m__PendingAcks.Reset();
+}
+
+void UGridReplicationComponent::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	FDoRepLifetimeParams Conditions;
+	Conditions.Condition = COND_InitialOnly;
+	DOREPLIFETIME_WITH_PARAMS(UGridReplicationComponent, m__Grid, Conditions);
+}
+
+void UGridReplicationComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (m__Grid && GetOwner()->HasAuthority())
+	{
+		for (const int32 ChunkIndex : m__RelevantChunks)
+		{
+			m__Grid->__RemoveChunkAudience(ChunkIndex, this);
+		}
+	}
+
+	m__RelevantChunks.Empty();
+	Super::EndPlay(EndPlayReason);
+}
+
+void UGridReplicationComponent::Initialize(ABuildingGrid* Grid)
+{
+	m__Grid = Grid;
+	SetIsReplicated(true);
+}
+
+void UGridReplicationComponent::__TickServer(const float DeltaTime)
+{
+	m__BlockEditsThisTick = 0;
+
+	if (!m__Grid->ReplicateChunks)
+		return;
+
+	const float BytesPerSecond = static_cast<float>(m__Grid->ChunkReplicationBytesPerSecond);
+
+	// At most a second of unused budget carries over, so an idle connection can not burst far past the limit.
+	m__ByteBudget = FMath::Min(m__ByteBudget + (BytesPerSecond * DeltaTime), BytesPerSecond);
+	m__TimeSincePendingUpdate += DeltaTime;
+
+	if (m__TimeSincePendingUpdate >= m__Grid->StreamingUpdateInterval)
+	{
+		m__TimeSincePendingUpdate = 0.f;
+		__UpdatePendingChunks();
+	}
+
+	__StartTransfers();
+	__SendFragments(GetWorld()->GetTimeSeconds());
+
+	if (m__Grid->ChunkVerificationInterval <= 0.f)
+		return;
+
+	m__TimeSinceVerification += DeltaTime;
+
+	if (m__TimeSinceVerification >= m__Grid->ChunkVerificationInterval)
+	{
+		m__TimeSinceVerification = 0.f;
+		__SendChunkHashes();
+	}
+}
+
+void UGridReplicationComponent::__UpdatePendingChunks()
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_STR(TEXT("UGridReplicationComponent::__UpdatePendingChunks()"))
+
+	const APlayerController* PlayerController = Cast<APlayerController>(GetOwner());
+
+	if (!PlayerController)
+		return;
+
+	FVector Location;
+	FVector Velocity;
+	ABuildingGrid::__GetPlayerLocation(PlayerController, Location, Velocity);
+
+	const FIntVector Source = m__Grid->_GetChunkPositionFromWorldLocation(Location);
+	const int32 Radius = m__Grid->StreamingRadiusInChunks;
+	const int32 VerticalRadius = m__Grid->StreamingVerticalRadiusInChunks;
+
+	// Chunks stay relevant for as long as the client keeps them loaded, so walking back and forth over the border does not send them again.
+	const int32 IrrelevantRadius = Radius + m__Grid->UnloadHysteresisInChunks;
+	const int32 IrrelevantVerticalRadius = VerticalRadius + m__Grid->UnloadHysteresisInChunks;
+
+	TArray<int32> IrrelevantChunks;
+	for (const int32 ChunkIndex : m__RelevantChunks)
+	{
+		const FIntVector Delta = UGridUtilities::ConvertToArrayPosition(ChunkIndex, m__Grid->m__ChunksAmountXY) - Source;
+
+		if ((Delta.X * Delta.X) + (Delta.Y * Delta.Y) > IrrelevantRadius * IrrelevantRadius || FMath::Abs(Delta.Z) > IrrelevantVerticalRadius)
+			IrrelevantChunks.Add(ChunkIndex);
+	}
+
+	for (const int32 ChunkIndex : IrrelevantChunks)
+	{
+		m__RelevantChunks.Remove(ChunkIndex);
+		m__AcknowledgedRevisions.Remove(ChunkIndex);
+		m__Transfers.Remove(ChunkIndex);
+		m__Grid->__RemoveChunkAudience(ChunkIndex, this);
+	}
+
+	if (!IrrelevantChunks.IsEmpty())
+		__ClientForgetChunks(IrrelevantChunks);
+
+	TArray<int32> DroppedTransfers;
+	for (const TPair<int32, FGridChunkTransfer>& Transfer : m__Transfers)
+	{
+		if (!m__Grid->m__Chunks[Transfer.Key])
+			DroppedTransfers.Add(Transfer.Key);
+	}
+
+	for (const int32 ChunkIndex : DroppedTransfers)
+	{
+		m__Transfers.Remove(ChunkIndex);
+	}
+
+	m__PendingChunks.Reset();
+
+	for (int z = -VerticalRadius; z <= VerticalRadius; z++)
+	{
+		for (int y = -Radius; y <= Radius; y++)
+		{
+			for (int x = -Radius; x <= Radius; x++)
+			{
+				const FIntVector ChunkPosition = Source + FIntVector(x, y, z);
+
+				if (!m__Grid->IsChunkPositionInsideGrid(ChunkPosition) || (x * x) + (y * y) > Radius * Radius)
+					continue;
+
+				const int32 ChunkIndex = UGridUtilities::ConvertToArrayIndex(ChunkPosition.X, ChunkPosition.Y, ChunkPosition.Z, m__Grid->m__ChunksAmountXY);
+				const AChunk* Chunk = m__Grid->m__Chunks[ChunkIndex];
+
+				if (!m__RelevantChunks.Contains(ChunkIndex))
+				{
+					m__RelevantChunks.Add(ChunkIndex);
+					m__Grid->__AddChunkAudience(ChunkIndex, this);
+				}
+
+				// Chunks the server has not loaded yet follow once they are.
+				if (!Chunk)
+					continue;
+
+				const uint32* AcknowledgedRevision = m__AcknowledgedRevisions.Find(ChunkIndex);
+				const FGridChunkTransfer* Transfer = m__Transfers.Find(ChunkIndex);
+
+				if ((AcknowledgedRevision && *AcknowledgedRevision == Chunk->GetRevision()) || (Transfer && Transfer->Revision == Chunk->GetRevision()))
+					continue;
+
+				m__PendingChunks.Add(FChunkStreamingRequest(ChunkIndex, (x * x) + (y * y) + (z * z)));
+			}
+		}
+	}
+
+	m__PendingChunks.Sort([](const FChunkStreamingRequest& A, const FChunkStreamingRequest& B)
+		{
+			return A.Priority > B.Priority;
+		});
+}
+
+void UGridReplicationComponent::__StartTransfers()
+{
+	while (!m__PendingChunks.IsEmpty())
+	{
+		// Summaries go out right away, so they wait for the budget like fragments do. Full transfers would not send anything before it recovers either.
+		if (m__ByteBudget <= 0.f)
+			break;
+
+		const int32 ChunkIndex = m__PendingChunks.Last().ChunkIndex;
+
+		// Restarting the transfer of a chunk that changed does not take another slot.
+		if (m__Transfers.Num() >= m__Grid->MaxChunkTransfersInFlight && !m__Transfers.Contains(ChunkIndex))
+			break;
+
+		const FChunkStreamingRequest Request = m__PendingChunks.Pop(false);
+		const AChunk* Chunk = m__Grid->m__Chunks[Request.ChunkIndex];
+		const uint32* AcknowledgedRevision = m__AcknowledgedRevisions.Find(Request.ChunkIndex);
+
+		// Unloaded or caught up through deltas since the last update.
+		if (!Chunk || (AcknowledgedRevision && *AcknowledgedRevision == Chunk->GetRevision()))
+			continue;
+
+		FGridChunkTransfer& Transfer = m__Transfers.Add(Request.ChunkIndex);
+		Transfer.ChunkIndex = Request.ChunkIndex;
+		Transfer.Revision = Chunk->GetRevision();
+		Transfer.Priority = Request.Priority;
+
+		FGridChunkSummary Summary;
+		TArray<TPair<int32, int32>> EditedBlocks;
+
+		// Chunks saving all of their blocks no longer know which of them were edited.
+		if (m__Grid->RegenerateChunksOnClients && Chunk->GetEditedBlocks(EditedBlocks))
+		{
+			UChunkCompressionUtilities::CompressBlockDeltas(EditedBlocks, Summary.EditedBlocks);
+
+			if (Summary.EditedBlocks.Num() <= m__Grid->MaxBlockDeltaBytes)
+			{
+				Summary.ChunkIndex = Request.ChunkIndex;
+				Summary.Revision = Transfer.Revision;
+				Summary.Checksum = Chunk->GetBlocksChecksum();
+				Transfer.bAwaitingVerification = true;
+
+				// The edited blocks plus the index, revision and checksum.
+				const int32 SummarySize = Summary.EditedBlocks.Num() + sizeof(int32) + sizeof(uint32) + sizeof(uint64);
+
+				__ClientReceiveChunkSummary(Summary);
+				m__ByteBudget -= SummarySize;
+				m__Grid->m__StreamingStats.TotalChunkBytesSent += SummarySize;
+				continue;
+			}
+		}
+
+		if (!__PrepareFullTransfer(Transfer, Chunk))
+			m__Transfers.Remove(Request.ChunkIndex);
+	}
+}
+
+bool UGridReplicationComponent::__PrepareFullTransfer(FGridChunkTransfer& Transfer, const AChunk* Chunk) const
+{
+	const int32 FragmentSize = FMath::Max(m__Grid->ChunkFragmentSize, 1);
+	Chunk->GetCompressedBlocks(Transfer.Data);
+
+	const int32 NumFragments = FMath::Max(FMath::DivideAndRoundUp(Transfer.Data.Num(), FragmentSize), 1);
+
+	if (NumFragments > MAX_uint16)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Chunk %d needs %d fragments to replicate, increase ChunkFragmentSize"), Transfer.ChunkIndex, NumFragments);
+		return false;
+	}
+
+	Transfer.bAwaitingVerification = false;
+	Transfer.FragmentSentTimes.Init(-1.0, NumFragments);
+	Transfer.AcknowledgedFragments.Init(false, NumFragments);
+	Transfer.NumAcknowledged = 0;
+	return true;
+}
+
+void UGridReplicationComponent::__SendFragments(const double Now)
+{
+	if (m__Transfers.IsEmpty() || m__ByteBudget <= 0.f)
+		return;
+
+	TArray<FGridChunkTransfer*> Transfers;
+	for (TPair<int32, FGridChunkTransfer>& Transfer : m__Transfers)
+	{
+		Transfers.Add(&Transfer.Value);
+	}
+
+	Transfers.Sort([](const FGridChunkTransfer& A, const FGridChunkTransfer& B)
+		{
+			return A.Priority < B.Priority;
+		});
+
+	const int32 FragmentSize = FMath::Max(m__Grid->ChunkFragmentSize, 1);
+	FChunkStreamingStats& Stats = m__Grid->m__StreamingStats;
+
+	for (FGridChunkTransfer* Transfer : Transfers)
+	{
+		if (Transfer->bAwaitingVerification)
+			continue;
+
+		const int32 NumFragments = Transfer->FragmentSentTimes.Num();
+
+		for (int32 FragmentIndex = 0; FragmentIndex < NumFragments; FragmentIndex++)
+		{
+			if (m__ByteBudget <= 0.f)
+				return;
+
+			const double SentTime = Transfer->FragmentSentTimes[FragmentIndex];
+
+			if (Transfer->AcknowledgedFragments[FragmentIndex] || (SentTime >= 0.0 && Now - SentTime < m__Grid->ChunkFragmentResendSeconds))
+				continue;
+
+			const int32 Offset = FragmentIndex * FragmentSize;
+
+			FGridChunkFragment Fragment;
+			Fragment.ChunkIndex = Transfer->ChunkIndex;
+			Fragment.Revision = Transfer->Revision;
+			Fragment.FragmentIndex = static_cast<uint16>(FragmentIndex);
+			Fragment.NumFragments = static_cast<uint16>(NumFragments);
+			Fragment.Data.Append(Transfer->Data.GetData() + Offset, FMath::Min(FragmentSize, Transfer->Data.Num() - Offset));
+
+			__ClientReceiveFragment(Fragment);
+
+			Transfer->FragmentSentTimes[FragmentIndex] = Now;
+			m__ByteBudget -= Fragment.Data.Num();
+			Stats.TotalChunkBytesSent += Fragment.Data.Num();
+
+			if (SentTime >= 0.0)
+				Stats.TotalChunkFragmentsResent++;
+		}
+	}
+}
+
+void UGridReplicationComponent::__ServerAcknowledgeFragments_Implementation(const TArray<FGridChunkFragmentAck>& Acks)
+{
+	for (const FGridChunkFragmentAck& Ack : Acks)
+	{
+		FGridChunkTransfer* Transfer = m__Transfers.Find(Ack.ChunkIndex);
+
+		// Acknowledgements of transfers that were restarted or dropped since.
+		if (!Transfer || Transfer->Revision != Ack.Revision || !Transfer->AcknowledgedFragments.IsValidIndex(Ack.FragmentIndex) || Transfer->AcknowledgedFragments[Ack.FragmentIndex])
+			continue;
+
+		Transfer->AcknowledgedFragments[Ack.FragmentIndex] = true;
+		Transfer->NumAcknowledged++;
+
+		if (Transfer->NumAcknowledged < Transfer->AcknowledgedFragments.Num())
+			continue;
+
+		m__AcknowledgedRevisions.Add(Ack.ChunkIndex, Ack.Revision);
+		m__Transfers.Remove(Ack.ChunkIndex);
+
+		if (m__Grid)
+			m__Grid->m__StreamingStats.TotalChunksReplicated++;
+	}
+}
+
+void UGridReplicationComponent::__ServerReportChunkVerification_Implementation(const int32 ChunkIndex, const uint32 Revision, const bool bMatched)
+{
+	FGridChunkTransfer* Transfer = m__Transfers.Find(ChunkIndex);
+
+	// Restarted or dropped since the summary went out.
+	if (!Transfer || Transfer->Revision != Revision || !Transfer->bAwaitingVerification || !m__Grid)
+		return;
+
+	FChunkStreamingStats& Stats = m__Grid->m__StreamingStats;
+
+	if (bMatched)
+	{
+		m__AcknowledgedRevisions.Add(ChunkIndex, Revision);
+		m__Transfers.Remove(ChunkIndex);
+		Stats.TotalChunksReplicated++;
+		Stats.TotalChunksVerified++;
+		return;
+	}
+
+	Stats.TotalChunkChecksumMismatches++;
+
+	const AChunk* Chunk = m__Grid->m__Chunks.IsValidIndex(ChunkIndex) ? m__Grid->m__Chunks[ChunkIndex] : nullptr;
+
+	// Changed or unloaded in the meantime, __UpdatePendingChunks starts over with the current revision.
+	if (!Chunk || Chunk->GetRevision() != Revision || !__PrepareFullTransfer(*Transfer, Chunk))
+		m__Transfers.Remove(ChunkIndex);
+}
+
+void UGridReplicationComponent::__SendBlockDeltas(const TArray<FGridChunkDelta>& Deltas)
+{
+	TArray<FGridChunkDelta> DeltasToSend;
+
+	for (const FGridChunkDelta& Delta : Deltas)
+	{
+		uint32* AcknowledgedRevision = m__AcknowledgedRevisions.Find(Delta.ChunkIndex);
+
+		if (!AcknowledgedRevision || *AcknowledgedRevision != Delta.BaseRevision)
+			continue;
+
+		// Reliable delivery means the client is at the new revision as far as the server is concerned.
+		*AcknowledgedRevision = Delta.Revision;
+		DeltasToSend.Add(Delta);
+		m__Grid->m__StreamingStats.TotalBlockDeltaBytesSent += Delta.Data.Num();
+	}
+
+	if (!DeltasToSend.IsEmpty())
+		__ClientReceiveBlockDeltas(DeltasToSend);
+}
+
+void UGridReplicationComponent::__SendChunkHashes()
+{
+	TArray<int32> ChunkIndices;
+	m__AcknowledgedRevisions.GenerateKeyArray(ChunkIndices);
+
+	if (ChunkIndices.IsEmpty())
+		return;
+
+	const int32 NumChecked = FMath::Min(ChunkIndices.Num(), m__Grid->ChunksVerifiedPerInterval);
+	TArray<FGridChunkHash> Hashes;
+
+	for (int32 Offset = 0; Offset < NumChecked; Offset++)
+	{
+		const int32 ChunkIndex = ChunkIndices[(m__VerificationCursor + Offset) % ChunkIndices.Num()];
+		const AChunk* Chunk = m__Grid->m__Chunks[ChunkIndex];
+
+		if (!Chunk || m__Transfers.Contains(ChunkIndex) || m__AcknowledgedRevisions[ChunkIndex] != Chunk->GetRevision())
+			continue;
+
+		Hashes.Add(FGridChunkHash(ChunkIndex, Chunk->GetRevision(), Chunk->GetBlocksHash()));
+	}
+
+	m__VerificationCursor = (m__VerificationCursor + NumChecked) % ChunkIndices.Num();
+
+	if (Hashes.IsEmpty())
+		return;
+
+	__ClientVerifyChunkHashes(Hashes);
+	m__Grid->m__StreamingStats.TotalChunkHashesSent += Hashes.Num();
+}
+
+void UGridReplicationComponent::__ServerReportDesyncedChunks_Implementation(const TArray<FGridChunkHash>& Hashes)
+{
+	if (!m__Grid)
+		return;
+
+	for (const FGridChunkHash& Hash : Hashes)
+	{
+		const uint32* AcknowledgedRevision = m__AcknowledgedRevisions.Find(Hash.ChunkIndex);
+
+		// Changed since the check, the client gets the new revision either way.
+		if (!AcknowledgedRevision || *AcknowledgedRevision != Hash.Revision)
+			continue;
+
+		UE_LOG(LogTemp, Warning, TEXT("Chunk %d desynced on %s, sending it again"), Hash.ChunkIndex, *GetOwner()->GetName());
+		m__AcknowledgedRevisions.Remove(Hash.ChunkIndex);
+		m__Grid->m__StreamingStats.TotalChunkDesyncRepairs++;
+	}
+}
+
+void UGridReplicationComponent::__ServerRequestBlockEdit_Implementation(const FGridBlockEditRequest& Request)
+{
+	const APlayerController* PlayerController = Cast<APlayerController>(GetOwner());
+	const bool bWithinLimit = m__Grid && ++m__BlockEditsThisTick <= m__Grid->MaxBlockEditsPerTick;
+
+	// Clients can only edit what they are able to see and reach.
+	const bool bAccepted = bWithinLimit && PlayerController && m__RelevantChunks.Contains(Request.ChunkIndex) && m__Grid->__ApplyRequestedBlockEdit(Request, PlayerController->GetPawn());
+
+	// Goes out before the deltas of this tick, which carry the edit itself.
+	__ClientResolveBlockEdit(Request.Sequence, bAccepted);
+}
+
+void UGridReplicationComponent::__ClientReceiveFragment_Implementation(const FGridChunkFragment& Fragment)
+{
+	// Without the grid the fragment is not acknowledged and simply sent again.
+	if (!m__Grid || Fragment.NumFragments == 0 || Fragment.FragmentIndex >= Fragment.NumFragments)
+		return;
+
+	// Duplicates are acknowledged as well, the acknowledgement of the first one may have been what got lost.
+	m__PendingAcks.Add(FGridChunkFragmentAck(Fragment.ChunkIndex, Fragment.Revision, Fragment.FragmentIndex));
+
+	const uint32* ReceivedRevision = m__ReceivedRevisions.Find(Fragment.ChunkIndex);
+
+	if (ReceivedRevision && *ReceivedRevision >= Fragment.Revision)
+		return;
+
+	FGridChunkReassembly& Reassembly = m__Reassemblies.FindOrAdd(Fragment.ChunkIndex);
+
+	// A late fragment of a revision that was already superseded.
+	if (Reassembly.Revision > Fragment.Revision)
+		return;
+
+	if (Reassembly.Revision != Fragment.Revision || Reassembly.Fragments.Num() != Fragment.NumFragments)
+	{
+		Reassembly.Revision = Fragment.Revision;
+		Reassembly.Fragments.Reset();
+		Reassembly.Fragments.SetNum(Fragment.NumFragments);
+		Reassembly.ReceivedFragments.Init(false, Fragment.NumFragments);
+		Reassembly.NumReceived = 0;
+	}
+
+	if (Reassembly.ReceivedFragments[Fragment.FragmentIndex])
+		return;
+
+	Reassembly.Fragments[Fragment.FragmentIndex] = Fragment.Data;
+	Reassembly.ReceivedFragments[Fragment.FragmentIndex] = true;
+	Reassembly.NumReceived++;
+
+	if (Reassembly.NumReceived < Reassembly.Fragments.Num())
+		return;
+
+	TArray<uint8> CompressedBlocks;
+	for (const TArray<uint8>& Data : Reassembly.Fragments)
+	{
+		CompressedBlocks.Append(Data);
+	}
+
+	m__ReceivedRevisions.Add(Fragment.ChunkIndex, Fragment.Revision);
+	m__Reassemblies.Remove(Fragment.ChunkIndex);
+	m__Grid->ApplyReplicatedChunk(Fragment.ChunkIndex, MoveTemp(CompressedBlocks));
+}
+
+void UGridReplicationComponent::__ClientReceiveChunkSummary_Implementation(const FGridChunkSummary& Summary)
+{
+	// Without the grid the client can not regenerate anything and has to take the full chunk.
+	if (!m__Grid)
+	{
+		__ServerReportChunkVerification(Summary.ChunkIndex, Summary.Revision, false);
+		return;
+	}
+
+	m__Grid->ApplyRegeneratedChunk(Summary.ChunkIndex, Summary.Checksum, Summary.EditedBlocks, [WeakThis = TWeakObjectPtr<UGridReplicationComponent>(this), ChunkIndex = Summary.ChunkIndex, Revision = Summary.Revision](const bool bMatched)
+		{
+			UGridReplicationComponent* This = WeakThis.Get();
+
+			if (!This)
+				return;
+
+			if (bMatched)
+				This->m__ReceivedRevisions.Add(ChunkIndex, Revision);
+
+			This->__ServerReportChunkVerification(ChunkIndex, Revision, bMatched);
+		});
+}
+
+void UGridReplicationComponent::__ClientReceiveBlockDeltas_Implementation(const TArray<FGridChunkDelta>& Deltas)
+{
+	if (!m__Grid)
+		return;
+
+	for (const FGridChunkDelta& Delta : Deltas)
+	{
+		uint32* ReceivedRevision = m__ReceivedRevisions.Find(Delta.ChunkIndex);
+
+		// The server only sends deltas on top of the revision it knows this client has.
+		if (!ReceivedRevision || *ReceivedRevision != Delta.BaseRevision)
+			continue;
+
+		if (!m__Grid->ApplyReplicatedBlockDeltas(Delta.ChunkIndex, Delta.Data))
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Failed to apply the replicated block deltas of chunk %d"), Delta.ChunkIndex);
+			continue;
+		}
+
+		*ReceivedRevision = Delta.Revision;
+	}
+}
+
+void UGridReplicationComponent::__ClientForgetChunks_Implementation(const TArray<int32>& ChunkIndices)
+{
+	for (const int32 ChunkIndex : ChunkIndices)
+	{
+		m__ReceivedRevisions.Remove(ChunkIndex);
+		m__Reassemblies.Remove(ChunkIndex);
+
+		if (m__Grid)
+			m__Grid->ForgetReplicatedChunk(ChunkIndex);
+	}
+}
+
+void UGridReplicationComponent::__ClientVerifyChunkHashes_Implementation(const TArray<FGridChunkHash>& Hashes)
+{
+	if (!m__Grid)
+		return;
+
+	TArray<FGridChunkHash> Desynced;
+
+	for (const FGridChunkHash& Hash : Hashes)
+	{
+		const uint32* ReceivedRevision = m__ReceivedRevisions.Find(Hash.ChunkIndex);
+		uint64 ClientHash = 0;
+
+		if (ReceivedRevision && *ReceivedRevision == Hash.Revision && m__Grid->GetReplicatedBlocksHash(Hash.ChunkIndex, ClientHash) && ClientHash == Hash.Hash)
+			continue;
+
+		// Otherwise the resent chunk would be taken for one the client already has.
+		m__ReceivedRevisions.Remove(Hash.ChunkIndex);
+		m__Reassemblies.Remove(Hash.ChunkIndex);
+		Desynced.Add(Hash);
+	}
+
+	if (!Desynced.IsEmpty())
+		__ServerReportDesyncedChunks(Desynced);
+}
+
+void UGridReplicationComponent::__ClientResolveBlockEdit_Implementation(const uint32 Sequence, const bool bAccepted)
+{
+	if (m__Grid)
+		m__Grid->__ResolvePredictedBlockEdit(Sequence, bAccepted);
+}
@@ -0,0 +1,113 @@
+// Copyright MikeSMediaStudios™ 2023
+
+#include "Environment/BuildingGrid/GridSchematic.h"
+#include "Environment/BuildingGrid/ChunkCompression.h"
+#include "Environment/BuildingGrid/GridUtilities.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+bool UGridSchematicUtilities::CreateSchematic(const TArray<int32>& Blocks, const FIntVector& Size, FGridSchematic& OutSchematic)
+{
+	if (UGridUtilities::GetNumBlocks(Size) != Blocks.Num())
+		return false;
+
+	OutSchematic.Size = Size;
+	UChunkCompressionUtilities::CompressBlocks(Blocks, OutSchematic.Blocks);
+	return true;
+}
+
+bool UGridSchematicUtilities::GetBlocks(const FGridSchematic& Schematic, TArray<int32>& OutBlocks)
+{
+	const int32 NumBlocks = UGridUtilities::GetNumBlocks(Schematic.Size);
+
+	return NumBlocks != INDEX_NONE && UChunkCompressionUtilities::DecompressBlocks(Schematic.Blocks, OutBlocks, NumBlocks);
+}
+
+void UGridSchematicUtilities::TransformBlocks(const TArray<int32>& Blocks, const FIntVector& Size, const int32 QuarterTurns, const bool bMirrorX, TArray<int32>& OutBlocks, FIntVector& OutSize)
+{
+	TRACE_CPUPROFILER_EVENT_SCOPE_STR(TEXT("UGridSchematicUtilities::TransformBlocks()"))
+
+	const int32 Turns = ((QuarterTurns % 4) + 4) % 4;
+	OutSize = Turns % 2 == 0 ? Size : FIntVector(Size.Y, Size.X, Size.Z);
+
+	OutBlocks.Reset();
+	OutBlocks.SetNumUninitialized(Blocks.Num());
+
+	for (int32 z = 0; z < Size.Z; z++)
+	{
+		for (int32 y = 0; y < Size.Y; y++)
+		{
+			for (int32 x = 0; x < Size.X; x++)
+			{
+				const int32 MirroredX = bMirrorX ? Size.X - 1 - x : x;
+				int32 NewX = MirroredX;
+				int32 NewY = y;
+
+				switch (Turns)
+				{
+				case 1:
+					NewX = Size.Y - 1 - y;
+					NewY = MirroredX;
+					break;
+				case 2:
+					NewX = Size.X - 1 - MirroredX;
+					NewY = Size.Y - 1 - y;
+					break;
+				case 3:
+					NewX = y;
+					NewY = Size.X - 1 - MirroredX;
+					break;
+				default:
+					break;
+				}
+
+				OutBlocks[NewX + (NewY * OutSize.X) + (z * OutSize.X * OutSize.Y)] = Blocks[x + (y * Size.X) + (z * Size.X * Size.Y)];
+			}
+		}
+	}
+}
+
+void UGridSchematicUtilities::SerializeSchematic(const FGridSchematic& Schematic, TArray<uint8>& OutData)
+{
+	OutData.Reset();
+	FMemoryWriter Writer(OutData);
+	uint8 Version = sm__FormatVersion;
+	FIntVector Size = Schematic.Size;
+	TArray<uint8> Blocks = Schematic.Blocks;
+
+	Writer << Version << Size << Blocks;
+}
+
+bool UGridSchematicUtilities::DeserializeSchematic(const TArray<uint8>& Data, FGridSchematic& OutSchematic, const int32 MaxNumBlocks)
+{
+	FMemoryReader Reader(Data);
+	uint8 Version = 0;
+	FIntVector Size = FIntVector::ZeroValue;
+
+	Reader << Version << Size;
+
+	if (Reader.IsError() || Version != sm__FormatVersion)
+		return false;
+
+	const int32 NumBlocks = UGridUtilities::GetNumBlocks(Size);
+	if (NumBlocks == INDEX_NONE || NumBlocks > MaxNumBlocks)
+		return false;
+
+	// Read like Reader << Blocks, but the count is checked against what is left of the data before it is allocated.
+	int32 NumBytes = 0;
+	Reader << NumBytes;
+
+	if (Reader.IsError() || NumBytes < 0 || NumBytes > Reader.TotalSize() - Reader.Tell())
+		return false;
+
+	TArray<uint8> Blocks;
+	Blocks.SetNumUninitialized(NumBytes);
+	Reader.Serialize(Blocks.GetData(), NumBytes);
+
+	if (Reader.IsError())
+		return false;
+
+	OutSchematic.Size = Size;
+	OutSchematic.Blocks = MoveTemp(Blocks);
+	return true;
+}
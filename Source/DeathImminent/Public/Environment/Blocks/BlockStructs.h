@@ -1,4 +1,4 @@
-// Copyright MikeSMediaStudios 2023
+// Copyright MikeSMediaStudios™ 2023
 
 #pragma once
 
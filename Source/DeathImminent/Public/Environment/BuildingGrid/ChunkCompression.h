@@ -0,0 +1,69 @@
+// Copyright MikeSMediaStudios™ 2023
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Kismet/BlueprintFunctionLibrary.h"
+#include "ChunkCompression.generated.h"
+
+/**
+ * Encodes chunk block arrays as a palette of the distinct packed block IDs followed by run lengths of palette indices.
+ * Chunks are mostly long runs of air and stone so this usually shrinks them by two orders of magnitude.
+ */
+UCLASS()
+class DEATHIMMINENT_API UChunkCompressionUtilities : public UBlueprintFunctionLibrary
+{
+	GENERATED_BODY()
+
+public:
+
+	/**
+	 * Replaces the contents of OutData with the compressed form of Blocks.
+	 */
+	static void CompressBlocks(const TArray<int32>& Blocks, TArray<uint8>& OutData);
+
+	/**
+	 * @param ExpectedNum Amount of blocks the chunk should contain, data for a differently sized chunk is rejected.
+	 * @return False if the data is corrupted or does not match ExpectedNum, OutBlocks is left in an unspecified state.
+	 */
+	static bool DecompressBlocks(const TArray<uint8>& Data, TArray<int32>& OutBlocks, const int32 ExpectedNum);
+
+	/**
+	 * Replaces the contents of OutData with sparse block edits for storing, see __WriteSortedEdits.
+	 */
+	static void CompressEditedBlocks(const TArray<TPair<int32, int32>>& EditedBlocks, TArray<uint8>& OutData);
+
+	/**
+	 * @param NumBlocks Amount of blocks in a chunk, edits outside of it are rejected.
+	 */
+	static bool DecompressEditedBlocks(const TArray<uint8>& Data, TArray<TPair<int32, int32>>& OutEditedBlocks, const int32 NumBlocks);
+
+	/**
+	 * Like CompressEditedBlocks but with a varint count and no version, for sending rather than storing.
+	 */
+	static void CompressBlockDeltas(const TArray<TPair<int32, int32>>& Deltas, TArray<uint8>& OutData);
+
+	/**
+	 * @param NumBlocks Amount of blocks in a chunk, deltas outside of it are rejected.
+	 */
+	static bool DecompressBlockDeltas(const TArray<uint8>& Data, TArray<TPair<int32, int32>>& OutDeltas, const int32 NumBlocks);
+
+private:
+
+	/**
+	 * Writes the body shared by edited blocks and block deltas, index deltas and blocks both varint encoded, so the edits have to be sorted by index.
+	 */
+	static void __WriteSortedEdits(FArchive& Writer, const TArray<TPair<int32, int32>>& Edits);
+
+	/**
+	 * @return False if the data is corrupted or holds edits outside of NumBlocks.
+	 */
+	static bool __ReadSortedEdits(FArchive& Reader, const int32 NumEdits, const int32 NumBlocks, TArray<TPair<int32, int32>>& OutEdits);
+
+private:
+
+	static constexpr uint8 sm__FormatVersion = 1;
+
+	// Separate from sm__FormatVersion, edited blocks stored before they shared the delta encoding hold their blocks unpacked.
+	static constexpr uint8 sm__EditedBlocksFormatVersion = 2;
+};
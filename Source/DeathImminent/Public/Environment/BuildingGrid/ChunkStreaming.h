@@ -0,0 +1,219 @@
+// Copyright MikeSMediaStudios™ 2023
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Environment/BuildingGrid/GridDeferredWrites.h"
+#include "Environment/BuildingGrid/GridRegionFile.h"
+#include "Environment/BuildingGrid/VoxelDataMeshStructs.h"
+#include "Tasks/Task.h"
+#include "ChunkStreaming.generated.h"
+
+USTRUCT(BlueprintType)
+struct FChunkStreamingStats
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "Streaming")
+	int32 LoadedChunks = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Streaming")
+	int32 QueuedForGeneration = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Streaming")
+	int32 QueuedForMeshing = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Streaming")
+	int32 TotalChunksLoaded = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Streaming")
+	int32 TotalChunksUnloaded = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Streaming|Pool")
+	int32 PooledChunks = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Streaming|Pool")
+	int32 TotalChunksSpawned = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Streaming|Pool")
+	int32 TotalChunksReused = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Streaming|Persistence")
+	int32 TotalChunksSaved = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Streaming|Persistence")
+	int32 TotalChunksLoadedFromDisk = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Streaming|Persistence")
+	int32 TotalAutosaves = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Streaming|Prefetch")
+	int32 PrefetchesInFlight = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Streaming|Prefetch")
+	int32 TotalPrefetchesIssued = 0;
+
+	// Prefetched chunks that were needed before they went out of range again.
+	UPROPERTY(BlueprintReadOnly, Category = "Streaming|Prefetch")
+	int32 TotalPrefetchHits = 0;
+
+	// Prefetched chunks that were thrown away because the player went elsewhere.
+	UPROPERTY(BlueprintReadOnly, Category = "Streaming|Prefetch")
+	int32 TotalPrefetchMisses = 0;
+
+	// Hits out of all prefetches that were either used or thrown away, 0 to 1.
+	UPROPERTY(BlueprintReadOnly, Category = "Streaming|Prefetch")
+	float PrefetchHitRate = 0.f;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Streaming|Compression")
+	int32 CompressedChunks = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Streaming|Compression")
+	int32 TotalChunksCompressed = 0;
+
+	// In bytes, of the blocks of every loaded chunk in whichever form they are held in.
+	UPROPERTY(BlueprintReadOnly, Category = "Streaming|Compression")
+	int64 ResidentBlocksMemory = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Streaming|Generation Cache")
+	int32 TotalChunksGenerated = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Streaming|Generation Cache")
+	int32 TotalChunksReadFromGenerationCache = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Streaming|Mesh Cache")
+	int32 TotalMeshesBuilt = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Streaming|Mesh Cache")
+	int32 TotalMeshesReadFromCache = 0;
+
+	// Meshes taken from another chunk with identical blocks instead of being built or read from disk.
+	UPROPERTY(BlueprintReadOnly, Category = "Streaming|Mesh Cache")
+	int32 TotalMeshesShared = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Streaming|Mesh Cache")
+	int32 SharedMeshes = 0;
+
+	// On the server, chunks relevant to at least one client. Only their edits are packed into deltas.
+	UPROPERTY(BlueprintReadOnly, Category = "Streaming|Replication")
+	int32 RelevantChunks = 0;
+
+	// On the server, chunks every fragment of which was acknowledged by a client.
+	UPROPERTY(BlueprintReadOnly, Category = "Streaming|Replication")
+	int32 TotalChunksReplicated = 0;
+
+	// On the server, in bytes of compressed chunk data including resends.
+	UPROPERTY(BlueprintReadOnly, Category = "Streaming|Replication")
+	int64 TotalChunkBytesSent = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Streaming|Replication")
+	int32 TotalChunkFragmentsResent = 0;
+
+	// On clients.
+	UPROPERTY(BlueprintReadOnly, Category = "Streaming|Replication")
+	int32 TotalChunksReceived = 0;
+
+	// On the server, in bytes of packed deltas summed over every connection they were sent to.
+	UPROPERTY(BlueprintReadOnly, Category = "Streaming|Replication")
+	int64 TotalBlockDeltaBytesSent = 0;
+
+	// On the server, chunks that were edited too much within a tick and were sent in full instead.
+	UPROPERTY(BlueprintReadOnly, Category = "Streaming|Replication")
+	int32 TotalOversizedBlockDeltas = 0;
+
+	// On clients.
+	UPROPERTY(BlueprintReadOnly, Category = "Streaming|Replication")
+	int32 TotalBlockDeltasReceived = 0;
+
+	// On the server, chunks a client regenerated from a summary instead of receiving them.
+	UPROPERTY(BlueprintReadOnly, Category = "Streaming|Replication")
+	int32 TotalChunksVerified = 0;
+
+	// On the server, summaries a client could not match, those chunks were sent in full.
+	UPROPERTY(BlueprintReadOnly, Category = "Streaming|Replication")
+	int32 TotalChunkChecksumMismatches = 0;
+
+	// On clients.
+	UPROPERTY(BlueprintReadOnly, Category = "Streaming|Replication")
+	int32 TotalChunksRegenerated = 0;
+
+	// On the server, chunk hashes sent to clients to check they are in sync.
+	UPROPERTY(BlueprintReadOnly, Category = "Streaming|Replication")
+	int32 TotalChunkHashesSent = 0;
+
+	// On the server, chunks a client held different blocks of than the server and that were sent again.
+	UPROPERTY(BlueprintReadOnly, Category = "Streaming|Replication")
+	int32 TotalChunkDesyncRepairs = 0;
+
+	// On clients, block edits shown before the server confirmed them.
+	UPROPERTY(BlueprintReadOnly, Category = "Streaming|Replication")
+	int32 TotalPredictedBlockEdits = 0;
+
+	// On clients, predicted block edits the server rejected and that were rolled back.
+	UPROPERTY(BlueprintReadOnly, Category = "Streaming|Replication")
+	int32 TotalRejectedBlockEdits = 0;
+};
+
+/**
+ * A chunk waiting to be generated or meshed, lower priority values are processed first.
+ */
+struct FChunkStreamingRequest
+{
+	FChunkStreamingRequest()
+		: ChunkIndex(INDEX_NONE)
+		, Priority(MAX_int32)
+	{
+	}
+
+	FChunkStreamingRequest(const int32 InChunkIndex, const int32 InPriority)
+		: ChunkIndex(InChunkIndex)
+		, Priority(InPriority)
+	{
+	}
+
+	int32 ChunkIndex;
+
+	// Squared distance in chunks to the closest player.
+	int32 Priority;
+};
+
+/**
+ * Everything a prefetch job produces for a chunk that is not spawned yet, adopted as is once the chunk is needed.
+ */
+struct FGridPrefetchedChunk
+{
+	TArray<int32> Blocks;
+	TArray<FGridDeferredWrite> DeferredWrites;
+
+	// Only valid if bHasSaveData is set.
+	FGridChunkSaveData SaveData;
+	bool bHasSaveData = false;
+
+	bool bFromGenerationCache = false;
+};
+
+/**
+ * A chunk summary of the server that is checked once the prefetch job generating the chunk is done, see ABuildingGrid::ApplyRegeneratedChunk.
+ */
+struct FGridPendingRegeneration
+{
+	UE::Tasks::TTask<FGridPrefetchedChunk> Job;
+	TArray<TPair<int32, int32>> Edits;
+	uint64 Checksum = 0;
+	TFunction<void(bool bMatched)> OnVerified;
+};
+
+/**
+ * A mesh kept in memory for every chunk whose mesher input hashes the same.
+ */
+struct FGridSharedMesh
+{
+	FGridSharedMesh(const TSharedRef<const FVoxelMeshSectionData>& InMeshData, const uint64 InLastUsedFrame)
+		: MeshData(InMeshData)
+		, LastUsedFrame(InLastUsedFrame)
+	{
+	}
+
+	TSharedRef<const FVoxelMeshSectionData> MeshData;
+	uint64 LastUsedFrame;
+};
@@ -0,0 +1,129 @@
+// Copyright MikeSMediaStudios™ 2023
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * A single block write aimed at a chunk that could not be written to directly,
+ * either because it is being generated on another thread or because it has not been generated yet.
+ */
+struct FGridDeferredWrite
+{
+	FGridDeferredWrite()
+		: GridLocation(FIntVector::ZeroValue)
+		, Block(0)
+		, bOnlyReplaceAir(true)
+	{
+	}
+
+	FGridDeferredWrite(const FIntVector& InGridLocation, const int32 InBlock, const bool bInOnlyReplaceAir)
+		: GridLocation(InGridLocation)
+		, Block(InBlock)
+		, bOnlyReplaceAir(bInOnlyReplaceAir)
+	{
+	}
+
+	// In grid coordinates, not local to any chunk.
+	FIntVector GridLocation;
+
+	// Packed block ID.
+	int32 Block;
+
+	// Structures should not overwrite terrain or what other structures already placed.
+	bool bOnlyReplaceAir;
+};
+
+/**
+ * Holds the writes every loaded chunk made into other chunks while it was generated, keyed by the index of that source chunk in the grid's chunk array.
+ * The writes are kept for as long as their source is loaded, so a target that unloads and comes back gets them again.
+ * Only ever touched on the game thread, generation workers collect their writes locally and hand them over once they are done.
+ */
+class DEATHIMMINENT_API FGridDeferredWriteBuffer
+{
+public:
+
+	/**
+	 * Replaces the writes of the source chunk, generating a chunk again must not queue its writes twice.
+	 * @param TargetChunkIndices Index of the chunk every write lands in, in the same order as Writes.
+	 */
+	void SetWrites(const int32 SourceChunkIndex, TArray<FGridDeferredWrite>&& Writes, TArray<int32>&& TargetChunkIndices)
+	{
+		check(Writes.Num() == TargetChunkIndices.Num());
+
+		RemoveSource(SourceChunkIndex);
+
+		if (Writes.IsEmpty())
+			return;
+
+		for (const int32 TargetChunkIndex : TargetChunkIndices)
+		{
+			m__SourcesByTarget.AddUnique(TargetChunkIndex, SourceChunkIndex);
+		}
+
+		FSourceWrites& SourceWrites = m__WritesBySource.Add(SourceChunkIndex);
+		SourceWrites.Writes = MoveTemp(Writes);
+		SourceWrites.TargetChunkIndices = MoveTemp(TargetChunkIndices);
+	}
+
+	/**
+	 * Drops the writes of a source chunk, has to be called once it unloads.
+	 */
+	void RemoveSource(const int32 SourceChunkIndex)
+	{
+		FSourceWrites SourceWrites;
+		if (!m__WritesBySource.RemoveAndCopyValue(SourceChunkIndex, SourceWrites))
+			return;
+
+		for (const int32 TargetChunkIndex : SourceWrites.TargetChunkIndices)
+		{
+			m__SourcesByTarget.RemoveSingle(TargetChunkIndex, SourceChunkIndex);
+		}
+	}
+
+	/**
+	 * Collects every write the loaded sources made into the target chunk, they stay queued for the next time it is generated.
+	 * @return False if nothing lands in that chunk.
+	 */
+	bool GetWritesInto(const int32 TargetChunkIndex, TArray<FGridDeferredWrite>& OutWrites) const
+	{
+		OutWrites.Reset();
+
+		for (auto It = m__SourcesByTarget.CreateConstKeyIterator(TargetChunkIndex); It; ++It)
+		{
+			const FSourceWrites& SourceWrites = m__WritesBySource.FindChecked(It.Value());
+
+			for (int32 Index = 0; Index < SourceWrites.Writes.Num(); Index++)
+			{
+				if (SourceWrites.TargetChunkIndices[Index] == TargetChunkIndex)
+					OutWrites.Add(SourceWrites.Writes[Index]);
+			}
+		}
+
+		return !OutWrites.IsEmpty();
+	}
+
+	int32 NumSources() const
+	{
+		return m__WritesBySource.Num();
+	}
+
+	void Reset()
+	{
+		m__WritesBySource.Reset();
+		m__SourcesByTarget.Reset();
+	}
+
+private:
+
+	struct FSourceWrites
+	{
+		TArray<FGridDeferredWrite> Writes;
+		TArray<int32> TargetChunkIndices;
+	};
+
+	TMap<int32, FSourceWrites> m__WritesBySource;
+
+	// Every target chunk with the sources writing into it, each pair only once.
+	TMultiMap<int32, int32> m__SourcesByTarget;
+};
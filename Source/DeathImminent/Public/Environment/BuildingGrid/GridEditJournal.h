@@ -0,0 +1,125 @@
+// Copyright MikeSMediaStudios™ 2023
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Tasks/Pipe.h"
+
+class IFileHandle;
+
+/**
+ * A single block edit as it is written to the journal.
+ */
+struct FGridEditJournalEntry
+{
+	FGridEditJournalEntry()
+		: ChunkPosition(FIntVector::ZeroValue)
+		, LocalIndex(INDEX_NONE)
+		, OldBlock(0)
+		, NewBlock(0)
+		, Tick(0)
+	{
+	}
+
+	FGridEditJournalEntry(const FIntVector& InChunkPosition, const int32 InLocalIndex, const int32 InOldBlock, const int32 InNewBlock, const uint32 InTick)
+		: ChunkPosition(InChunkPosition)
+		, LocalIndex(InLocalIndex)
+		, OldBlock(InOldBlock)
+		, NewBlock(InNewBlock)
+		, Tick(InTick)
+	{
+	}
+
+	FIntVector ChunkPosition;
+
+	// Index of the block inside its chunk. An index into the whole grid does not fit into an int32 for large grids.
+	int32 LocalIndex;
+
+	// Packed block IDs.
+	int32 OldBlock;
+	int32 NewBlock;
+
+	// Frame the edit happened on.
+	uint32 Tick;
+};
+
+/**
+ * Append only log of every block edit made on the server, replayed on top of the region files after a crash.
+ * Edits are buffered on the game thread and written once per frame as a single checksummed group on a background pipe.
+ * The log is split into numbered segments so the ones covered by a committed snapshot can be deleted.
+ */
+class DEATHIMMINENT_API FGridEditJournal : public TSharedFromThis<FGridEditJournal, ESPMode::ThreadSafe>
+{
+public:
+
+	explicit FGridEditJournal(const FString& InDirectory);
+	~FGridEditJournal();
+
+	/**
+	 * Reads every complete group of every segment in the directory in the order they were written.
+	 * A group that was only partially written when the process died is ignored together with everything after it.
+	 * Segments of another format version are skipped.
+	 * @param OutSegments Numbers of the segments that were read or skipped, all of them can be deleted once the entries are saved.
+	 */
+	static void ReadAll(const FString& Directory, TArray<FGridEditJournalEntry>& OutEntries, TArray<int32>& OutSegments);
+
+	/**
+	 * Starts a new segment after the ones already in the directory.
+	 */
+	bool Open();
+
+	void Append(const FGridEditJournalEntry& Entry);
+
+	/**
+	 * Writes everything appended since the last call as a single group.
+	 */
+	void CommitAsync();
+
+	/**
+	 * Commits and closes the current segment and starts the next one.
+	 * @return Number of the segment that was closed, every edit before the call is in it or an earlier segment.
+	 */
+	int32 Rotate();
+
+	/**
+	 * Deletes every segment up to and including LastSegment once everything queued before has been written.
+	 * Unlike the rest of the methods this one can be called from any thread, Flush does not wait for it.
+	 */
+	void DeleteSegmentsAsync(const int32 LastSegment);
+
+	/**
+	 * Blocks until everything that was queued so far is done.
+	 */
+	void Flush();
+
+	const FString& GetDirectory() const
+	{
+		return m__Directory;
+	}
+
+private:
+
+	// Written at the start of every segment.
+	static constexpr uint32 sm__Magic = 0x4A524E4C;
+	static constexpr uint32 sm__FormatVersion = 2;
+
+	static FString __GetSegmentFilename(const FString& Directory, const int32 Segment);
+	static void __FindSegments(const FString& Directory, TArray<int32>& OutSegments);
+
+	void __WriteGroup(const TArray<FGridEditJournalEntry>& Entries);
+	void __OpenSegment(const int32 Segment);
+
+private:
+
+	FString m__Directory;
+
+	// Only touched on the write pipe.
+	TUniquePtr<IFileHandle> m__FileHandle;
+
+	// Only touched on the game thread.
+	TArray<FGridEditJournalEntry> m__Buffer;
+	int32 m__CurrentSegment = 0;
+
+	UE::Tasks::FPipe m__WritePipe;
+	UE::Tasks::FTask m__LastWrite;
+};
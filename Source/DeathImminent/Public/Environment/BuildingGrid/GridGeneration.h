@@ -0,0 +1,293 @@
+// Copyright MikeSMediaStudios™ 2023
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Kismet/BlueprintFunctionLibrary.h"
+#include "Templates/ChooseClass.h"
+#include "Environment/Blocks/BlockStructs.h"
+#include "Environment/BuildingGrid/GridDeferredWrites.h"
+#include "GridGeneration.generated.h"
+
+UENUM(BlueprintType, meta = (Bitflags, UseEnumValuesAsMaskValuesInEditor = "true"))
+enum class EGridGenerationStage : uint8
+{
+	GS_None               = 0       UMETA(Hidden),
+	GS_Heightmap          = 0x01    UMETA(DisplayName = "Heightmap"),
+	GS_Biomes             = 0x02    UMETA(DisplayName = "Biome Selection"),
+	GS_Caves              = 0x04    UMETA(DisplayName = "Cave Carving"),
+	GS_OreVeins           = 0x08    UMETA(DisplayName = "Ore Veins"),
+	GS_SurfaceDecoration  = 0x10    UMETA(DisplayName = "Surface Decoration"),
+	GS_Structures         = 0x20    UMETA(DisplayName = "Structures"),
+	GS_All                = 0x3f    UMETA(Hidden)
+};
+ENUM_CLASS_FLAGS(EGridGenerationStage)
+
+UENUM(BlueprintType)
+enum class EGridBiome : uint8
+{
+	GB_Plains    UMETA(DisplayName = "Plains"),
+	GB_Desert    UMETA(DisplayName = "Desert"),
+	GB_Mountains UMETA(DisplayName = "Mountains")
+};
+
+/**
+ * Parameters of the generation stages that are not shared with the base terrain noise (Seed, Octaves, Zoom etc. live on the grid itself).
+ */
+USTRUCT(BlueprintType)
+struct FGridGenerationSettings
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Blocks")
+	FBlockID StoneBlock = FBlockID(0, 1);
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Blocks")
+	FBlockID DirtBlock = FBlockID(0, 2);
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Blocks")
+	FBlockID GrassBlock = FBlockID(0, 3);
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Blocks")
+	FBlockID SandBlock = FBlockID(0, 4);
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Blocks")
+	FBlockID OreBlock = FBlockID(0, 5);
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Blocks")
+	FBlockID WoodBlock = FBlockID(0, 6);
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Blocks")
+	FBlockID LeavesBlock = FBlockID(0, 7);
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Biomes")
+	float BiomeZoom = .01f;
+
+	// Columns whose height is above this fraction of the Ceiling become mountains.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Biomes", meta = (ClampMin = 0, ClampMax = 1))
+	float MountainThreshold = .7f;
+
+	// Columns whose moisture noise is below this value become deserts.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Biomes", meta = (ClampMin = 0, ClampMax = 1))
+	float DesertThreshold = .35f;
+
+	// Solid blocks whose cave noise is at or below this value are carved out.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Caves", meta = (ClampMin = 0, ClampMax = 1))
+	float CaveThreshold = .4f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Ores")
+	float OreZoom = .08f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Ores", meta = (ClampMin = 0, ClampMax = 1))
+	float OreThreshold = .8f;
+
+	// Ores never generate closer than this to the surface of their column.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Ores", meta = (ClampMin = 0))
+	int32 OreMinDepth = 4;
+
+	// Amount of blocks under the top block that get replaced by the biome's sub-surface block.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Surface", meta = (ClampMin = 0))
+	int32 SurfaceDepth = 3;
+
+	// Chance for every plains column to grow a tree.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Structures", meta = (ClampMin = 0, ClampMax = 1))
+	float TreeDensity = .01f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Structures", meta = (ClampMin = 1))
+	int32 TreeMinHeight = 4;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Structures", meta = (ClampMin = 1))
+	int32 TreeMaxHeight = 7;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Structures", meta = (ClampMin = 0))
+	int32 TreeCanopyRadius = 2;
+};
+
+/**
+ * Everything a generation stage needs to fill one chunk.
+ * Built once per chunk by the grid, stages only ever write into the chunk's own block array so chunks can be generated in parallel.
+ */
+struct FGridGenerationContext
+{
+	FGridGenerationContext(TArray<int32>& InBlocks, const FIntVector& InStartGridLocation, const int32 InWidthInBlocks, const int32 InHeightInBlocks, const int32 InGridWidthInBlocks, const int32 InGridHeightInBlocks, const FGridGenerationSettings& InSettings)
+		: Blocks(InBlocks)
+		, StartGridLocation(InStartGridLocation)
+		, WidthInBlocks(InWidthInBlocks)
+		, HeightInBlocks(InHeightInBlocks)
+		, GridWidthInBlocks(InGridWidthInBlocks)
+		, GridHeightInBlocks(InGridHeightInBlocks)
+		, Settings(InSettings)
+	{
+		ColumnHeights.SetNumZeroed(WidthInBlocks * WidthInBlocks);
+		ColumnBiomes.Init(EGridBiome::GB_Plains, WidthInBlocks * WidthInBlocks);
+	}
+
+	FORCEINLINE int32 ColumnIndex(const int32 x, const int32 y) const
+	{
+		return x + (y * WidthInBlocks);
+	}
+
+	FORCEINLINE int32 BlockIndex(const int32 x, const int32 y, const int32 z) const
+	{
+		return x + (y * WidthInBlocks) + (z * WidthInBlocks * WidthInBlocks);
+	}
+
+	/**
+	 * Writes into the chunk directly if the location is inside of it, otherwise queues the write for the chunk that owns it.
+	 * Structures use this so they can span chunk boundaries without touching another chunk's blocks from a worker thread.
+	 */
+	FORCEINLINE void SetBlockOrDefer(const FIntVector& GridLocation, const int32 Block, const bool bOnlyReplaceAir = true)
+	{
+		const bool IsInsideGrid = ((GridLocation.X >= 0 && GridLocation.X < GridWidthInBlocks) && (GridLocation.Y >= 0 && GridLocation.Y < GridWidthInBlocks)) && (GridLocation.Z >= 0 && GridLocation.Z < GridHeightInBlocks);
+		if (!IsInsideGrid)
+			return;
+
+		const FIntVector Local = GridLocation - StartGridLocation;
+		const bool IsInsideChunk = ((Local.X >= 0 && Local.X < WidthInBlocks) && (Local.Y >= 0 && Local.Y < WidthInBlocks)) && (Local.Z >= 0 && Local.Z < HeightInBlocks);
+
+		if (!IsInsideChunk)
+		{
+			DeferredWrites.Add(FGridDeferredWrite(GridLocation, Block, bOnlyReplaceAir));
+			return;
+		}
+
+		int32& Target = Blocks[BlockIndex(Local.X, Local.Y, Local.Z)];
+		if (bOnlyReplaceAir && Target != 0)
+			return;
+
+		Target = Block;
+	}
+
+	// Local block array of the chunk that is being generated.
+	TArray<int32>& Blocks;
+
+	FIntVector StartGridLocation;
+	int32 WidthInBlocks;
+	int32 HeightInBlocks;
+	int32 GridWidthInBlocks;
+	int32 GridHeightInBlocks;
+	const FGridGenerationSettings& Settings;
+
+	// Terrain noise parameters copied from the grid.
+	int32 Seed = 0;
+	int32 Octaves = 1;
+	int32 Ceiling = 0;
+	int32 Floor = 0;
+	float Zoom = 0.f;
+	float Lucanarity = 0.f;
+	float Persistence = 0.f;
+
+	// Packed block IDs resolved once per chunk.
+	int32 StoneBlock = 0;
+	int32 DirtBlock = 0;
+	int32 GrassBlock = 0;
+	int32 SandBlock = 0;
+	int32 OreBlock = 0;
+	int32 WoodBlock = 0;
+	int32 LeavesBlock = 0;
+
+	// Grid Z of the first air block above the terrain of every column in the chunk.
+	TArray<int32> ColumnHeights;
+	TArray<EGridBiome> ColumnBiomes;
+
+	// Writes the structure stage made outside of this chunk, handed to the grid once the chunk is done.
+	TArray<FGridDeferredWrite> DeferredWrites;
+};
+
+#pragma region Stages
+/**
+ * Every stage processes a whole chunk per call, stages are plain structs with a static Execute so the pipeline can inline them.
+ * They are defined in GridGeneration.cpp next to UGridGenerationUtilities::GenerateChunk, which instantiates every pipeline.
+ */
+struct FGridNoOpStage
+{
+	static FORCEINLINE void Execute(FGridGenerationContext& Context) {}
+};
+
+// Used instead of the heightmap when it is disabled, fills the whole chunk with stone so the other stages have something to work with.
+struct FGridSolidFillStage
+{
+	static void Execute(FGridGenerationContext& Context);
+};
+
+struct FGridHeightmapStage
+{
+	static void Execute(FGridGenerationContext& Context);
+};
+
+struct FGridBiomeStage
+{
+	static void Execute(FGridGenerationContext& Context);
+};
+
+struct FGridCaveStage
+{
+	static void Execute(FGridGenerationContext& Context);
+};
+
+struct FGridOreVeinStage
+{
+	static void Execute(FGridGenerationContext& Context);
+};
+
+struct FGridSurfaceDecorationStage
+{
+	static void Execute(FGridGenerationContext& Context);
+};
+
+/**
+ * Places structures that may cross chunk boundaries. Every structure is anchored to exactly one column so it is only ever placed by one chunk,
+ * blocks landing in other chunks go through FGridGenerationContext::SetBlockOrDefer.
+ */
+struct FGridStructureStage
+{
+	static void Execute(FGridGenerationContext& Context);
+
+private:
+
+	static void __PlaceTree(FGridGenerationContext& Context, const FIntVector& GroundLocation, const int32 TrunkHeight);
+};
+#pragma endregion
+
+#pragma region Pipeline
+template<typename... TStages>
+struct TGridGenerationPipeline
+{
+	static void Execute(FGridGenerationContext& Context)
+	{
+		(TStages::Execute(Context), ...);
+	}
+};
+
+template<uint8 StageMask, EGridGenerationStage Stage, typename TStage>
+using TGridGenerationStageIf = typename TChooseClass<(StageMask & static_cast<uint8>(Stage)) != 0, TStage, FGridNoOpStage>::Result;
+
+/**
+ * The pipeline a given stage mask compiles into. Disabled stages collapse into FGridNoOpStage.
+ */
+template<uint8 StageMask>
+using TGridGenerationPipelineForMask = TGridGenerationPipeline<
+	typename TChooseClass<(StageMask & static_cast<uint8>(EGridGenerationStage::GS_Heightmap)) != 0, FGridHeightmapStage, FGridSolidFillStage>::Result,
+	TGridGenerationStageIf<StageMask, EGridGenerationStage::GS_Biomes, FGridBiomeStage>,
+	TGridGenerationStageIf<StageMask, EGridGenerationStage::GS_Caves, FGridCaveStage>,
+	TGridGenerationStageIf<StageMask, EGridGenerationStage::GS_OreVeins, FGridOreVeinStage>,
+	TGridGenerationStageIf<StageMask, EGridGenerationStage::GS_SurfaceDecoration, FGridSurfaceDecorationStage>,
+	TGridGenerationStageIf<StageMask, EGridGenerationStage::GS_Structures, FGridStructureStage>>;
+#pragma endregion
+
+UCLASS()
+class DEATHIMMINENT_API UGridGenerationUtilities : public UBlueprintFunctionLibrary
+{
+	GENERATED_BODY()
+
+public:
+
+	/**
+	 * Runs the pipeline that was compiled for the given stage mask over the chunk described by the context.
+	 * The mask is resolved once per chunk, there is no dispatch per block.
+	 */
+	static void GenerateChunk(FGridGenerationContext& Context, const uint8 StageMask);
+
+	// Bump whenever the pipeline produces different blocks for the same settings, so cached chunks of older versions are not used.
+	static constexpr uint32 GeneratorVersion = 1;
+};
@@ -0,0 +1,70 @@
+// Copyright MikeSMediaStudios™ 2023
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Environment/BuildingGrid/GridDeferredWrites.h"
+#include "Environment/BuildingGrid/GridRegionFile.h"
+#include "Tasks/Pipe.h"
+
+/**
+ * Keeps the output of the generation pipeline on disk so chunks do not have to be generated again on the next start.
+ * Every combination of seed and generation settings gets its own directory named after their hash, so changing any of them starts a new cache.
+ * Entries are stored in region files, reads and writes can happen on any thread, commits run on a background pipe.
+ */
+class DEATHIMMINENT_API FGridGenerationCache : public TSharedFromThis<FGridGenerationCache, ESPMode::ThreadSafe>
+{
+public:
+
+	/**
+	 * @param InParentDirectory Directory the caches of all settings live in.
+	 * @param InSettingsHash Hash of the seed and every setting that affects generation.
+	 */
+	FGridGenerationCache(const FString& InParentDirectory, const uint32 InSettingsHash, const int32 InChunkWidthInBlocks, const int32 InChunkHeightInBlocks);
+	~FGridGenerationCache();
+
+	/**
+	 * @return False if the chunk was never cached with the current settings.
+	 */
+	bool ReadChunk(const FIntVector& ChunkPosition, TArray<int32>& OutBlocks, TArray<FGridDeferredWrite>& OutDeferredWrites);
+
+	/**
+	 * Compresses the chunk on the calling thread and stages it, nothing reaches the disk before the next CommitAsync.
+	 */
+	void WriteChunk(const FIntVector& ChunkPosition, const TArray<int32>& Blocks, const TArray<FGridDeferredWrite>& DeferredWrites);
+
+	/**
+	 * Commits every region with staged chunks, does nothing if nothing was written since the last commit.
+	 */
+	void CommitAsync();
+
+	/**
+	 * Deletes the caches of every other hash in the parent directory in the background, they can never be read again.
+	 */
+	void DeleteStaleCachesAsync();
+
+	/**
+	 * Blocks until everything that was queued so far is done.
+	 */
+	void Flush();
+
+	const FString& GetDirectory() const
+	{
+		return m__RegionFiles.GetDirectory();
+	}
+
+private:
+
+	static constexpr uint8 sm__FormatVersion = 1;
+
+	FString m__ParentDirectory;
+	int32 m__ChunkWidthInBlocks;
+	int32 m__ChunkHeightInBlocks;
+
+	FGridRegionFileSet m__RegionFiles;
+
+	std::atomic<bool> m__bHasStagedChunks = false;
+
+	UE::Tasks::FPipe m__WritePipe;
+	UE::Tasks::FTask m__LastWrite;
+};
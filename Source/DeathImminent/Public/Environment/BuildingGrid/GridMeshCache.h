@@ -0,0 +1,54 @@
+// Copyright MikeSMediaStudios™ 2023
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Environment/BuildingGrid/GridRegionFile.h"
+#include "Environment/BuildingGrid/VoxelDataMeshStructs.h"
+#include "Tasks/Pipe.h"
+
+/**
+ * Keeps the last mesh built for every chunk on disk together with the hash of the blocks it was built from,
+ * so chunks that did not change since the last session can be shown without running the mesher.
+ * Reads and writes can happen on any thread, commits run on a background pipe.
+ */
+class DEATHIMMINENT_API FGridMeshCache : public TSharedFromThis<FGridMeshCache, ESPMode::ThreadSafe>
+{
+public:
+
+	FGridMeshCache(const FString& InDirectory, const int32 InChunkWidthInBlocks, const int32 InChunkHeightInBlocks);
+	~FGridMeshCache();
+
+	/**
+	 * @param ContentHash Hash of everything the mesher reads, see UGridMeshUtilities::GetMeshInputHash.
+	 * @param Algorithm The meshing algorithm the mesh has to be built with.
+	 * @return False if the cached mesh of the chunk was built from anything else or by another UGridMeshUtilities::MesherVersion.
+	 */
+	bool ReadMesh(const FIntVector& ChunkPosition, const uint64 ContentHash, const uint8 Algorithm, const int32 BlockSize, FVoxelMeshSectionData& OutMeshData);
+
+	/**
+	 * Packs the mesh on the calling thread and stages it, replacing whatever was cached for the chunk. Nothing reaches the disk before the next CommitAsync.
+	 */
+	void WriteMesh(const FIntVector& ChunkPosition, const uint64 ContentHash, const uint8 Algorithm, const int32 BlockSize, const FVoxelMeshSectionData& MeshData);
+
+	/**
+	 * Commits every region with staged meshes, does nothing if nothing was written since the last commit.
+	 */
+	void CommitAsync();
+
+	/**
+	 * Blocks until everything that was queued so far is done.
+	 */
+	void Flush();
+
+private:
+
+	static constexpr uint8 sm__FormatVersion = 2;
+
+	FGridRegionFileSet m__RegionFiles;
+
+	std::atomic<bool> m__bHasStagedMeshes = false;
+
+	UE::Tasks::FPipe m__WritePipe;
+	UE::Tasks::FTask m__LastWrite;
+};
@@ -1,4 +1,4 @@
-// Copyright MikeSMediaStudios 2023
+// Copyright MikeSMediaStudios™ 2023
 
 #pragma once
 
@@ -31,6 +31,15 @@ public:
 	UFUNCTION(BlueprintCallable)
 	static void SurfaceNetsNew(FVoxelMeshSectionData& MeshData);
 
+	/**
+	 * Hashes everything the mesher reads for the chunk, two chunks with the same hash get the same mesh.
+	 * @param IncludeNeighbours If true the layer of blocks around the chunk is hashed as well, for algorithms that sample across the border.
+	 */
+	static uint64 GetMeshInputHash(const AChunk* Chunk, const bool IncludeNeighbours);
+
+	// Bump whenever any algorithm builds a different mesh from the same blocks, so cached and shared meshes of older versions are not used.
+	static constexpr uint32 MesherVersion = 1;
+
 private:
 
 #pragma region Greedy Meshing Algorithm
@@ -0,0 +1,53 @@
+// Copyright MikeSMediaStudios™ 2023
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Environment/Blocks/BlockStructs.h"
+#include "GridQueries.generated.h"
+
+/**
+ * A line between two points in world space, see ABuildingGrid::TraceSegments.
+ */
+USTRUCT(BlueprintType)
+struct FGridSegment
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Grid|Queries")
+	FVector Start = FVector::ZeroVector;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Grid|Queries")
+	FVector End = FVector::ZeroVector;
+};
+
+/**
+ * Result of ABuildingGrid::RaycastBlocks and ABuildingGrid::TraceSegments.
+ */
+USTRUCT(BlueprintType)
+struct FGridRaycastHit
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "Grid|Queries")
+	bool bHit = false;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Grid|Queries")
+	FBlockID Block;
+
+	// In grid coordinates, not local to any chunk.
+	UPROPERTY(BlueprintReadOnly, Category = "Grid|Queries")
+	FIntVector GridLocation = FIntVector::ZeroValue;
+
+	// Of the face the ray entered the block through in grid space, zero if the ray started inside the block.
+	UPROPERTY(BlueprintReadOnly, Category = "Grid|Queries")
+	FIntVector Normal = FIntVector::ZeroValue;
+
+	// In world space, where the ray entered the block.
+	UPROPERTY(BlueprintReadOnly, Category = "Grid|Queries")
+	FVector Location = FVector::ZeroVector;
+
+	// In units from the start of the ray.
+	UPROPERTY(BlueprintReadOnly, Category = "Grid|Queries")
+	float Distance = 0.f;
+};
@@ -0,0 +1,262 @@
+// Copyright MikeSMediaStudios™ 2023
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Tasks/Pipe.h"
+
+class IFileHandle;
+
+enum class EGridChunkSaveKind : uint8
+{
+	// Every block of the chunk, used once a chunk was edited too much for a diff to pay off.
+	SK_AllBlocks,
+
+	// Only the blocks that were edited since generation, applied on top of a freshly generated chunk.
+	SK_EditedBlocks
+};
+
+/**
+ * What gets persisted of a chunk, chunks that were never edited are not saved at all and get regenerated instead.
+ */
+struct FGridChunkSaveData
+{
+	EGridChunkSaveKind Kind = EGridChunkSaveKind::SK_EditedBlocks;
+
+	// Only filled for SK_AllBlocks.
+	TArray<int32> Blocks;
+
+	// Only filled for SK_EditedBlocks, local block index and packed block ID sorted by index.
+	TArray<TPair<int32, int32>> EditedBlocks;
+};
+
+/**
+ * A single region file holding RegionSizeInChunks^3 chunks.
+ * The file starts with a header and an offset table with one entry per chunk, followed by 4KB sectors with the compressed chunks.
+ * Reading a chunk only touches its table entry and its own sectors.
+ * Writes are staged in memory until Commit, which writes the whole region to a temporary file and swaps it in,
+ * so a crash leaves either the old or the new region on disk and never a half written one.
+ * All methods are thread safe.
+ */
+class DEATHIMMINENT_API FGridRegionFile
+{
+public:
+
+	static constexpr int32 RegionSizeInChunks = 8;
+	static constexpr int32 ChunksPerRegion = RegionSizeInChunks * RegionSizeInChunks * RegionSizeInChunks;
+	static constexpr int64 SectorSize = 4096;
+
+	// Files of this version are still read, they are rewritten with the current version on their next commit.
+	static constexpr uint32 FirstVersion = 1;
+
+	FGridRegionFile(const FString& InFilename, const int32 InChunkWidthInBlocks, const int32 InChunkHeightInBlocks);
+	~FGridRegionFile();
+
+	/**
+	 * Opens the file if it exists, recovering it from the temporary file if a commit was interrupted while swapping them.
+	 * @return False if the file could not be opened or was written for differently sized chunks.
+	 */
+	bool Open();
+
+	/**
+	 * @param LocalIndex Index of the chunk inside this region, see GetLocalIndex.
+	 * @param OutVersion Version of the file the chunk was written with, for callers that have to migrate chunks of FirstVersion.
+	 * @return False if the chunk was never written to this region.
+	 */
+	bool ReadChunk(const int32 LocalIndex, TArray<uint8>& OutData, uint32* OutVersion = nullptr);
+
+	/**
+	 * Stages the chunk, it is only written to disk on the next Commit.
+	 */
+	bool WriteChunk(const int32 LocalIndex, TArray<uint8>&& Data);
+	bool HasChunk(const int32 LocalIndex);
+
+	/**
+	 * Writes the region with all staged chunks to a temporary file and replaces the region file with it.
+	 * Does nothing if nothing was staged since the last commit. Reads and writes are only blocked while the files are swapped.
+	 */
+	bool Commit();
+
+	static FORCEINLINE FIntVector GetRegionPosition(const FIntVector& ChunkPosition)
+	{
+		return FIntVector(ChunkPosition.X / RegionSizeInChunks, ChunkPosition.Y / RegionSizeInChunks, ChunkPosition.Z / RegionSizeInChunks);
+	}
+
+	static FORCEINLINE int32 GetLocalIndex(const FIntVector& ChunkPosition)
+	{
+		const int32 x = ChunkPosition.X % RegionSizeInChunks;
+		const int32 y = ChunkPosition.Y % RegionSizeInChunks;
+		const int32 z = ChunkPosition.Z % RegionSizeInChunks;
+		return x + (y * RegionSizeInChunks) + (z * RegionSizeInChunks * RegionSizeInChunks);
+	}
+
+private:
+
+	struct FTableEntry
+	{
+		uint32 SectorOffset = 0;
+		uint32 ByteLength = 0;
+	};
+
+	static constexpr uint32 sm__Magic = 0x47524944;
+	static constexpr uint32 sm__Version = 2;
+	static constexpr int64 sm__HeaderSize = sizeof(uint32) * 4;
+	static constexpr int64 sm__HeaderSectors = (sm__HeaderSize + (ChunksPerRegion * sizeof(FTableEntry)) + SectorSize - 1) / SectorSize;
+
+	static FORCEINLINE uint32 __GetSectorCount(const uint32 ByteLength)
+	{
+		return static_cast<uint32>((ByteLength + SectorSize - 1) / SectorSize);
+	}
+
+	/**
+	 * Reads the header and the offset table from the start of the file.
+	 * @param OutVersion sm__Version or FirstVersion.
+	 * @return False if the file is too short, was not written by a known version for chunks of this size or its table points past the end of the file.
+	 */
+	bool __ReadHeader(IFileHandle& FileHandle, FTableEntry* OutTable, uint32& OutVersion) const;
+
+	/**
+	 * @return True if the file has a valid header, which also means it is long enough for every chunk its table points to, so a commit finished writing it.
+	 */
+	bool __IsCompleteRegionFile(const FString& Filename) const;
+
+	/**
+	 * Reads a chunk that is already committed, the lock has to be held.
+	 */
+	bool __ReadCommittedChunk(const int32 LocalIndex, TArray<uint8>& OutData);
+
+	/**
+	 * Reads the chunk at Entry from the given handle, which must not be used by another thread at the same time.
+	 */
+	static bool __ReadCommittedChunk(IFileHandle* FileHandle, const FTableEntry& Entry, TArray<uint8>& OutData);
+
+	FString __GetTemporaryFilename() const
+	{
+		return m__Filename + TEXT(".tmp");
+	}
+
+private:
+
+	FString m__Filename;
+	int32 m__ChunkWidthInBlocks;
+	int32 m__ChunkHeightInBlocks;
+
+	// Null until the region was committed at least once.
+	TUniquePtr<IFileHandle> m__FileHandle;
+	FTableEntry m__Table[ChunksPerRegion];
+
+	// Version the committed file was written with, reported by ReadChunk.
+	uint32 m__FileVersion = sm__Version;
+
+	TMap<int32, TArray<uint8>> m__StagedChunks;
+
+	FCriticalSection m__Lock;
+
+	// Held for the whole Commit, so only one of them writes the temporary file at a time.
+	FCriticalSection m__CommitLock;
+};
+
+/**
+ * The region files of one directory, each opened on first use. Thread safe.
+ */
+class DEATHIMMINENT_API FGridRegionFileSet
+{
+public:
+
+	FGridRegionFileSet(const FString& InDirectory, const int32 InChunkWidthInBlocks, const int32 InChunkHeightInBlocks);
+
+	/**
+	 * @return The region file containing the chunk, opening it if needed. Null if it can not be opened.
+	 */
+	FGridRegionFile* GetRegionFile(const FIntVector& ChunkPosition);
+
+	/**
+	 * Commits every open region.
+	 * @return False if any region failed to commit, those keep their staged chunks for the next try.
+	 */
+	bool CommitAll();
+
+	const FString& GetDirectory() const
+	{
+		return m__Directory;
+	}
+
+private:
+
+	FString m__Directory;
+	int32 m__ChunkWidthInBlocks;
+	int32 m__ChunkHeightInBlocks;
+
+	TMap<FIntVector, TUniquePtr<FGridRegionFile>> m__RegionFiles;
+	FCriticalSection m__Lock;
+};
+
+/**
+ * Owns the region files of one world and compresses chunks on their way to and from disk.
+ * Writes and commits are applied in order on a background pipe, reads see writes that are still in flight.
+ */
+class DEATHIMMINENT_API FGridRegionStorage : public TSharedFromThis<FGridRegionStorage, ESPMode::ThreadSafe>
+{
+public:
+
+	FGridRegionStorage(const FString& InDirectory, const int32 InChunkWidthInBlocks, const int32 InChunkHeightInBlocks);
+	~FGridRegionStorage();
+
+	/**
+	 * Reads and decompresses a chunk on the calling thread.
+	 * @return False if the chunk was never saved.
+	 */
+	bool ReadChunk(const FIntVector& ChunkPosition, FGridChunkSaveData& OutData);
+
+	/**
+	 * Compresses and stages a chunk in its region on a background thread, Data is taken by value so the caller can keep editing its own copy.
+	 * Nothing reaches the disk before the next CommitAsync.
+	 */
+	void WriteChunkAsync(const FIntVector& ChunkPosition, FGridChunkSaveData Data);
+
+	/**
+	 * Commits every region with staged chunks once the writes issued so far are staged.
+	 * @param OnCommitted Called on the background pipe afterwards, with false if any region failed to commit.
+	 */
+	void CommitAsync(TFunction<void(bool bCommitted)>&& OnCommitted = nullptr);
+
+	bool HasChunk(const FIntVector& ChunkPosition);
+
+	/**
+	 * Blocks until every write and commit that was issued so far is done.
+	 */
+	void Flush();
+
+	int32 GetNumPendingWrites() const;
+
+	const FString& GetDirectory() const
+	{
+		return m__Directory;
+	}
+
+private:
+
+	struct FPendingWrite
+	{
+		FGridChunkSaveData Data;
+		uint64 Serial = 0;
+	};
+
+	void __WritePending(const FIntVector& ChunkPosition, const uint64 Serial);
+
+private:
+
+	FString m__Directory;
+	int32 m__ChunkWidthInBlocks;
+	int32 m__ChunkHeightInBlocks;
+
+	FGridRegionFileSet m__RegionFiles;
+
+	// Newest data of chunks that are not written yet, reads are served from here first.
+	TMap<FIntVector, FPendingWrite> m__PendingWrites;
+	mutable FCriticalSection m__PendingWritesLock;
+	uint64 m__NextSerial = 1;
+
+	UE::Tasks::FPipe m__WritePipe;
+	UE::Tasks::FTask m__LastWrite;
+};
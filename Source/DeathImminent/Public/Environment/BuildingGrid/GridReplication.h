@@ -0,0 +1,375 @@
+// Copyright MikeSMediaStudios™ 2023
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "Environment/BuildingGrid/ChunkStreaming.h"
+#include "GridReplication.generated.h"
+
+class ABuildingGrid;
+class AChunk;
+
+/**
+ * A slice of a compressed chunk, small enough to fit into a single packet.
+ */
+USTRUCT()
+struct FGridChunkFragment
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	int32 ChunkIndex = INDEX_NONE;
+
+	// Grows whenever the blocks of the chunk change on the server, fragments of different revisions are never mixed.
+	UPROPERTY()
+	uint32 Revision = 0;
+
+	UPROPERTY()
+	uint16 FragmentIndex = 0;
+
+	UPROPERTY()
+	uint16 NumFragments = 0;
+
+	UPROPERTY()
+	TArray<uint8> Data;
+};
+
+USTRUCT()
+struct FGridChunkFragmentAck
+{
+	GENERATED_BODY()
+
+	FGridChunkFragmentAck()
+	{
+	}
+
+	FGridChunkFragmentAck(const int32 InChunkIndex, const uint32 InRevision, const uint16 InFragmentIndex)
+		: ChunkIndex(InChunkIndex)
+		, Revision(InRevision)
+		, FragmentIndex(InFragmentIndex)
+	{
+	}
+
+	UPROPERTY()
+	int32 ChunkIndex = INDEX_NONE;
+
+	UPROPERTY()
+	uint32 Revision = 0;
+
+	UPROPERTY()
+	uint16 FragmentIndex = 0;
+};
+
+/**
+ * Lets a client rebuild a chunk from the seed instead of receiving its blocks.
+ * The client generates the chunk, applies the edits and only needs the full chunk if the result does not match the checksum.
+ */
+USTRUCT()
+struct FGridChunkSummary
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	int32 ChunkIndex = INDEX_NONE;
+
+	UPROPERTY()
+	uint32 Revision = 0;
+
+	// Of the blocks on the server, see UGridUtilities::GetBlocksChecksum.
+	UPROPERTY()
+	uint64 Checksum = 0;
+
+	// Every block edited since generation, packed with UChunkCompressionUtilities::CompressBlockDeltas.
+	UPROPERTY()
+	TArray<uint8> EditedBlocks;
+};
+
+/**
+ * What a client should hold of a chunk, see AChunk::GetBlocksHash.
+ */
+USTRUCT()
+struct FGridChunkHash
+{
+	GENERATED_BODY()
+
+	FGridChunkHash()
+	{
+	}
+
+	FGridChunkHash(const int32 InChunkIndex, const uint32 InRevision, const uint64 InHash)
+		: ChunkIndex(InChunkIndex)
+		, Revision(InRevision)
+		, Hash(InHash)
+	{
+	}
+
+	UPROPERTY()
+	int32 ChunkIndex = INDEX_NONE;
+
+	UPROPERTY()
+	uint32 Revision = 0;
+
+	UPROPERTY()
+	uint64 Hash = 0;
+};
+
+/**
+ * Every block of a chunk that changed on the server within one tick, packed with UChunkCompressionUtilities::CompressBlockDeltas.
+ */
+USTRUCT()
+struct FGridChunkDelta
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	int32 ChunkIndex = INDEX_NONE;
+
+	// The revision the deltas apply to, clients holding any other one ignore them.
+	UPROPERTY()
+	uint32 BaseRevision = 0;
+
+	// The revision of the chunk once they are applied.
+	UPROPERTY()
+	uint32 Revision = 0;
+
+	UPROPERTY()
+	TArray<uint8> Data;
+};
+
+/**
+ * Blocks of a chunk edited on the server since the deltas were last sent.
+ */
+struct FGridPendingBlockDelta
+{
+	uint32 BaseRevision = 0;
+
+	// Local block index to the latest packed block ID.
+	TMap<int32, int32> Blocks;
+};
+
+/**
+ * A block edit a client already applied locally and asks the server to make.
+ */
+USTRUCT()
+struct FGridBlockEditRequest
+{
+	GENERATED_BODY()
+
+	// Grows with every prediction of the client, the server answers them in the same order.
+	UPROPERTY()
+	uint32 Sequence = 0;
+
+	UPROPERTY()
+	int32 ChunkIndex = INDEX_NONE;
+
+	UPROPERTY()
+	int32 LocalIndex = INDEX_NONE;
+
+	// Places a block if true, hits the block otherwise.
+	UPROPERTY()
+	bool bPlace = false;
+};
+
+/**
+ * A block a client predicted edits of that the server did not answer yet.
+ */
+struct FGridPredictedBlock
+{
+	// The block as far as the server is concerned, shown again once every prediction on top of it is rejected.
+	int32 ServerBlock = 0;
+
+	// By sequence, oldest first. The latest one is what the client shows.
+	TArray<TPair<uint32, int32>> PendingBlocks;
+};
+
+/**
+ * A chunk the server is sending to a client.
+ */
+struct FGridChunkTransfer
+{
+	int32 ChunkIndex = INDEX_NONE;
+	uint32 Revision = 0;
+
+	// Squared distance in chunks to the client's player when the transfer started.
+	int32 Priority = 0;
+
+	// Set while the client checks the chunk it regenerated against a summary, no fragments are sent until it reports a mismatch.
+	bool bAwaitingVerification = false;
+
+	// The compressed blocks, sliced into fragments on the fly.
+	TArray<uint8> Data;
+
+	// In seconds of world time, negative for fragments that were not sent yet.
+	TArray<double> FragmentSentTimes;
+	TBitArray<> AcknowledgedFragments;
+	int32 NumAcknowledged = 0;
+};
+
+/**
+ * A chunk whose fragments are still arriving on a client.
+ */
+struct FGridChunkReassembly
+{
+	uint32 Revision = 0;
+	TArray<TArray<uint8>> Fragments;
+	TBitArray<> ReceivedFragments;
+	int32 NumReceived = 0;
+};
+
+/**
+ * Added to every remote player controller by the grid on the server, sends that client the authoritative blocks of the chunks around its player.
+ * Chunks go out palette and run length compressed, nearest first and split into fragments within a per connection byte budget.
+ * Fragments are sent unreliably and acknowledged by the client, a transfer interrupted by packet loss only sends the missing fragments again.
+ */
+UCLASS(ClassGroup = (Grid))
+class DEATHIMMINENT_API UGridReplicationComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+	friend class ABuildingGrid;
+
+public:
+
+	//~Begin UActorComponent section
+	UGridReplicationComponent();
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+	//~End UActorComponent section
+
+	/**
+	 * Has to be called on the server before the component is registered.
+	 */
+	void Initialize(ABuildingGrid* Grid);
+
+private:
+
+#pragma region Server
+	void __TickServer(const float DeltaTime);
+
+	/**
+	 * Updates the chunks that are relevant to the client and collects the loaded ones around its player that it does not have the current revision of, closest last.
+	 * Chunks past the unload hysteresis stop being relevant, their transfers are dropped and the client forgets them.
+	 */
+	void __UpdatePendingChunks();
+
+	/**
+	 * Starts transfers of pending chunks until MaxChunkTransfersInFlight is reached or the byte budget is used up.
+	 * Chunks with few edits start out as a summary the client can regenerate them from, the rest are compressed and sent in full.
+	 */
+	void __StartTransfers();
+
+	/**
+	 * Compresses the chunk into the transfer and slices it into fragments.
+	 * @return False if the chunk needs more fragments than a transfer can hold.
+	 */
+	bool __PrepareFullTransfer(FGridChunkTransfer& Transfer, const AChunk* Chunk) const;
+
+	/**
+	 * Sends fragments that were never sent or were not acknowledged in time, closest chunks first, until the byte budget runs out.
+	 */
+	void __SendFragments(const double Now);
+
+	UFUNCTION(Server, Reliable)
+	void __ServerAcknowledgeFragments(const TArray<FGridChunkFragmentAck>& Acks);
+
+	/**
+	 * @param bMatched False if the regenerated chunk did not match the summary's checksum, the full chunk is sent then.
+	 */
+	UFUNCTION(Server, Reliable)
+	void __ServerReportChunkVerification(const int32 ChunkIndex, const uint32 Revision, const bool bMatched);
+
+	/**
+	 * Sends the deltas of every chunk the client holds the base revision of in a single message, the grid only hands over those of relevant chunks.
+	 * Chunks it does not hold are sent in full later since their revision changed.
+	 */
+	void __SendBlockDeltas(const TArray<FGridChunkDelta>& Deltas);
+
+	/**
+	 * Makes the edit if the block can still be edited that way and answers the client either way.
+	 */
+	UFUNCTION(Server, Reliable)
+	void __ServerRequestBlockEdit(const FGridBlockEditRequest& Request);
+
+	/**
+	 * Sends the hashes of the next ChunksVerifiedPerInterval chunks the client acknowledged the current revision of.
+	 * Chunks with a transfer or deltas on their way are left for a later check.
+	 */
+	void __SendChunkHashes();
+
+	/**
+	 * Forgets that the client has the chunks, so they are sent again.
+	 */
+	UFUNCTION(Server, Reliable)
+	void __ServerReportDesyncedChunks(const TArray<FGridChunkHash>& Hashes);
+#pragma endregion Server
+
+#pragma region Client
+	UFUNCTION(Client, Unreliable)
+	void __ClientReceiveFragment(const FGridChunkFragment& Fragment);
+
+	UFUNCTION(Client, Reliable)
+	void __ClientReceiveChunkSummary(const FGridChunkSummary& Summary);
+
+	// Reliable, deltas build on top of each other so none of them can go missing.
+	UFUNCTION(Client, Reliable)
+	void __ClientReceiveBlockDeltas(const TArray<FGridChunkDelta>& Deltas);
+
+	/**
+	 * The chunks are no longer relevant to the client, the server stops sending their deltas so whatever it holds of them would go stale.
+	 */
+	UFUNCTION(Client, Reliable)
+	void __ClientForgetChunks(const TArray<int32>& ChunkIndices);
+
+	// Reliable, so the deltas sent before it are applied by the time the hashes are compared.
+	UFUNCTION(Client, Reliable)
+	void __ClientVerifyChunkHashes(const TArray<FGridChunkHash>& Hashes);
+
+	/**
+	 * Sent before the deltas of the edit, so the prediction is resolved by the time the server's block arrives.
+	 */
+	UFUNCTION(Client, Reliable)
+	void __ClientResolveBlockEdit(const uint32 Sequence, const bool bAccepted);
+#pragma endregion Client
+
+private:
+
+	UPROPERTY(Replicated)
+	ABuildingGrid* m__Grid;
+
+	// Server only, chunks within the streaming radius of the client's player, kept until they are past the unload hysteresis.
+	TSet<int32> m__RelevantChunks;
+
+	// Server only, closest last so they can be popped off the end.
+	TArray<FChunkStreamingRequest> m__PendingChunks;
+
+	// Server only, by chunk index.
+	TMap<int32, FGridChunkTransfer> m__Transfers;
+
+	// Server only, the revision of every chunk the client received completely.
+	TMap<int32, uint32> m__AcknowledgedRevisions;
+
+	// Server only, in bytes. Can go negative, the fragment that overdraws it is paid back before the next one is sent.
+	float m__ByteBudget = 0.f;
+
+	float m__TimeSincePendingUpdate = MAX_flt;
+
+	// Server only.
+	float m__TimeSinceVerification = 0.f;
+
+	// Server only, where the next __SendChunkHashes picks up among the acknowledged chunks.
+	int32 m__VerificationCursor = 0;
+
+	// Server only, edit requests handled since the last tick.
+	int32 m__BlockEditsThisTick = 0;
+
+	// Client only, by chunk index.
+	TMap<int32, FGridChunkReassembly> m__Reassemblies;
+
+	// Client only, the revision of every chunk that was received completely.
+	TMap<int32, uint32> m__ReceivedRevisions;
+
+	// Client only, sent in one batch every tick.
+	TArray<FGridChunkFragmentAck> m__PendingAcks;
+};
@@ -0,0 +1,65 @@
+// Copyright MikeSMediaStudios™ 2023
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Kismet/BlueprintFunctionLibrary.h"
+#include "GridSchematic.generated.h"
+
+/**
+ * A box of blocks copied out of a grid, see ABuildingGrid::CopySchematic and ABuildingGrid::PasteSchematic.
+ * The blocks are kept compressed, so schematics are cheap to hold on to and to send in RPCs.
+ */
+USTRUCT(BlueprintType)
+struct FGridSchematic
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "Grid|Schematics")
+	FIntVector Size = FIntVector::ZeroValue;
+
+	// Packed block IDs, X first, then Y, then Z. Compressed with UChunkCompressionUtilities::CompressBlocks.
+	UPROPERTY()
+	TArray<uint8> Blocks;
+};
+
+UCLASS()
+class DEATHIMMINENT_API UGridSchematicUtilities : public UBlueprintFunctionLibrary
+{
+	GENERATED_BODY()
+
+public:
+
+	/**
+	 * @param Blocks Laid out like the blocks of ABuildingGrid::ReadRegion.
+	 * @return False if Blocks does not hold Size blocks.
+	 */
+	static bool CreateSchematic(const TArray<int32>& Blocks, const FIntVector& Size, FGridSchematic& OutSchematic);
+
+	/**
+	 * @return False if the schematic is corrupted.
+	 */
+	static bool GetBlocks(const FGridSchematic& Schematic, TArray<int32>& OutBlocks);
+
+	/**
+	 * Mirrors the blocks along X first, then turns them counterclockwise around Z as seen from above.
+	 */
+	static void TransformBlocks(const TArray<int32>& Blocks, const FIntVector& Size, const int32 QuarterTurns, const bool bMirrorX, TArray<int32>& OutBlocks, FIntVector& OutSize);
+
+	/**
+	 * Replaces the contents of OutData with the schematic, for sharing or storing it.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Grid|Schematics")
+	static void SerializeSchematic(const FGridSchematic& Schematic, TArray<uint8>& OutData);
+
+	/**
+	 * @param MaxNumBlocks Schematics holding more blocks are rejected before anything is allocated for them.
+	 * @return False if the data is not a schematic of this version, is corrupted or is too large.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Grid|Schematics")
+	static bool DeserializeSchematic(const TArray<uint8>& Data, FGridSchematic& OutSchematic, const int32 MaxNumBlocks = 4194304);
+
+private:
+
+	static constexpr uint8 sm__FormatVersion = 1;
+};